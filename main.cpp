@@ -1,15 +1,8 @@
 #include <raylib.h>
 #include <raymath.h>
-#include <cstring>
-#include <cstdio>
-#include <cctype>
-#include <vector>
-#include <string>
-#include <algorithm>
-#include <iostream>
-#include <cmath>
-#include <string>
-using namespace std;
+#include "ums_core.h"
+#include <atomic>
+#include <thread>
 
 static inline void DrawRoundedBorder(Rectangle rec, float roundness, int segments, float lineThick, Color color)
 {
@@ -60,386 +53,59 @@ string GetColorLegendText(int index)
     }
 }
 
-class Student
-{
-public:
-    int ID;
-    string Name;
-    string Email;
-    string Phone;
-    string Address;
-    string Password;
-};
-
-class StudentNode
-{
-public:
-    Student data;
-    StudentNode *next;
-};
-
-class Course
-{
-public:
-    int courseID;
-    string courseName;
-    int courseCredits;
-    string courseInstructor;
-
-    int maxCapacity;
-    int currentEnrolled;
-
-    static const int MAX_PREREQS = 10;
-    int prereqIDs[MAX_PREREQS];
-    int prereqCount;
-
-    Course()
-    {
-        prereqCount = 0;
-        for (int i = 0; i < MAX_PREREQS; i++)
-        {
-            prereqIDs[i] = -1;
-        }
-        maxCapacity = 0;
-        currentEnrolled = 0;
-    }
-};
-
-class CourseNode
-{
-public:
-    Course data;
-    CourseNode *left;
-    CourseNode *right;
-};
-
-class Enrollment
-{
-public:
-    int studentID;
-    int courseID;
-};
-
-class EnrollmentNode
-{
-public:
-    Enrollment data;
-    EnrollmentNode *next;
-    EnrollmentNode *prev;
-};
-
-class WaitlistItem
-{
-public:
-    int studentID;
-    int courseID;
-};
-
-class CourseHashNode
-{
-public:
-    Course *data;
-    CourseHashNode *next;
-};
-
-StudentNode *gStudentHead = NULL;
-CourseNode *gCourseRoot = NULL;
-EnrollmentNode *gEnrollmentHead = NULL;
-EnrollmentNode *gEnrollmentTail = NULL;
-
-static const int MAX_Q = 10;
-WaitlistItem waitlistQ[MAX_Q];
-int frontIdx = 0, rearIdx = -1, qCount = 0;
-
-static const int TABLE_SIZE = 10;
-CourseHashNode *courseTable[TABLE_SIZE];
-
-static const int MAX_STACK = 10;
-int prereqStack[MAX_STACK];
-int stackTop = -1;
-
-bool courseExists(int cID);
-bool studentExists(int id);
-
-Student *searchStudentByID(int id);
-Course *searchCourseByID(int cID);
-
-bool isStudentEnrolledInCourse(int studentID, int courseID);
-bool meetsPrerequisites(int studentID, const Course &course);
-
-void addEnrollment(int studentID, int courseID);
-void viewEnrollment(int studentID);
-bool validatePrerequisites(int courseID, int studentID);
-bool enqueueWaitlist(int studentID, int courseID);
-bool dequeueWaitlist();
-void initCourseHashTable();
-void insertCourseHash(Course *cPtr);
-Course *searchCourseHash(int cID);
-int rebuildHashFromBST(CourseNode *node);
-bool deleteCourseHash(int cID);
-
 void studentMenu();
 void courseMenu();
 void enrollmentMenu();
-void prereqStackMenu();
+void prereqMenu();
 void waitlistQueueMenu();
 void hashTableMenu();
-
-bool studentExists(int id)
-{
-    StudentNode *temp = gStudentHead;
-    while (temp != NULL)
-    {
-        if (temp->data.ID == id)
-        {
-            return true;
-        }
-        temp = temp->next;
-    }
-    return false;
-}
-
-void addStudent(int id, const string &name, const string &email,
-                const string &phone, const string &address, const string &password)
-{
-    if (studentExists(id))
-    {
-        cout << "Error: A student with ID " << id << " already exists.\n";
-        return;
-    }
-    StudentNode *newNode = new StudentNode;
-    newNode->data.ID = id;
-    newNode->data.Name = name;
-    newNode->data.Email = email;
-    newNode->data.Phone = phone;
-    newNode->data.Address = address;
-    newNode->data.Password = password;
-    newNode->next = NULL;
-
-    if (gStudentHead == NULL)
-    {
-        gStudentHead = newNode;
-        return;
-    }
-    StudentNode *temp = gStudentHead;
-    while (temp->next != NULL)
-    {
-        temp = temp->next;
-    }
-    temp->next = newNode;
-}
-
-bool deleteStudent(int id)
-{
-    if (gStudentHead == NULL)
-        return false;
-    if (gStudentHead->data.ID == id)
-    {
-        StudentNode *toDelete = gStudentHead;
-        gStudentHead = gStudentHead->next;
-        delete toDelete;
-        return true;
-    }
-    StudentNode *current = gStudentHead;
-    while (current->next != NULL && current->next->data.ID != id)
-    {
-        current = current->next;
-    }
-    if (current->next == NULL)
-    {
-        return false;
-    }
-    StudentNode *toDelete = current->next;
-    current->next = toDelete->next;
-    delete toDelete;
-    return true;
-}
+void memoryMenu();
+void snapshotMenu();
+void importMenu();
 
 void displayStudents()
 {
     cout << "\n-- Displaying All Students --\n";
-    if (gStudentHead == NULL)
+    if (gStudents.size() == 0)
     {
         cout << "[No students found]\n";
         return;
     }
-    StudentNode *temp = gStudentHead;
-    while (temp != NULL)
+    for (const Student &s : gStudents.records)
     {
-        cout << "Student ID: " << temp->data.ID << "\n"
-             << "  Name: " << temp->data.Name << "\n"
-             << "  Email: " << temp->data.Email << "\n"
-             << "  Phone: " << temp->data.Phone << "\n"
-             << "  Address: " << temp->data.Address << "\n"
-             << "  Password: " << temp->data.Password << "\n"
+        cout << "Student ID: " << s.ID << "\n"
+             << "  Name: " << s.Name << "\n"
+             << "  Email: " << s.Email << "\n"
+             << "  Phone: " << s.Phone << "\n"
+             << "  Address: " << s.Address << "\n"
+             << "  Password: " << s.Password << "\n"
              << "---------------------------------\n";
-        temp = temp->next;
     }
     cout << endl;
 }
 
-Student *searchStudentByID(int id)
+static void printPoolStats(const char *name, const PoolStats &st)
 {
-    StudentNode *temp = gStudentHead;
-    while (temp != NULL)
-    {
-        if (temp->data.ID == id)
-        {
-            return &(temp->data);
-        }
-        temp = temp->next;
-    }
-    return NULL;
+    printf("  %-12s live: %-9d reserved: %-10.1f KB  fragmentation: %.1f%%\n",
+           name, st.live, st.bytesReserved / 1024.0, st.fragmentation * 100.0);
 }
 
-void sortStudentsByID()
+// Prints " label: a, b, c" for the direct prerequisites of a course, or for the
+// courses it unlocks; prints nothing when the list is empty.
+static void printCourseLinks(const char *label, int courseID, bool unlocks)
 {
-    if (gStudentHead == NULL || gStudentHead->next == NULL)
-        return;
-
-    bool swapped;
-    do
-    {
-        swapped = false;
-        StudentNode *current = gStudentHead;
-        while (current->next != NULL)
-        {
-            if (current->data.ID > current->next->data.ID)
-            {
-                Student temp = current->data;
-                current->data = current->next->data;
-                current->next->data = temp;
-                swapped = true;
-            }
-            current = current->next;
-        }
-    } while (swapped);
-}
-
-class CourseNode;
-
-CourseNode *insertCourseHelper(CourseNode *node, const Course &c)
-{
-    if (node == NULL)
-    {
-        CourseNode *newNode = new CourseNode;
-        newNode->data = c;
-        newNode->left = NULL;
-        newNode->right = NULL;
-        return newNode;
-    }
-    if (c.courseID < node->data.courseID)
+    bool first = true;
+    auto print = [&](int id)
     {
-        node->left = insertCourseHelper(node->left, c);
-    }
-    else if (c.courseID > node->data.courseID)
-    {
-        node->right = insertCourseHelper(node->right, c);
-    }
-    return node;
-}
-
-bool courseExists(int cID)
-{
-    return (searchCourseByID(cID) != NULL);
-}
-
-CourseNode *searchCourseHelper(CourseNode *node, int cID)
-{
-    if (node == NULL)
-        return NULL;
-    if (node->data.courseID == cID)
-        return node;
-    if (cID < node->data.courseID)
-    {
-        return searchCourseHelper(node->left, cID);
-    }
+        cout << (first ? label : ", ") << id;
+        first = false;
+    };
+    if (unlocks)
+        gPrereqs.forEachDependant(courseID, print);
     else
-    {
-        return searchCourseHelper(node->right, cID);
-    }
-}
-
-Course *searchCourseByID(int cID)
-{
-    Course *c = searchCourseHash(cID);
-    if (c)
-        return c;
-
-    CourseNode *found = searchCourseHelper(gCourseRoot, cID);
-    if (found)
-        return &(found->data);
-
-    return NULL;
-}
-
-CourseNode *insertCourseBST(const Course &c)
-{
-    if (courseExists(c.courseID))
-    {
-        return NULL;
-    }
-
-    gCourseRoot = insertCourseHelper(gCourseRoot, c);
-    CourseNode *node = searchCourseHelper(gCourseRoot, c.courseID);
-
-    if (node)
-    {
-        insertCourseHash(&node->data);
-    }
-
-    return node;
-}
-
-CourseNode *findMinCourseNode(CourseNode *node)
-{
-    while (node && node->left)
-    {
-        node = node->left;
-    }
-    return node;
-}
-
-CourseNode *dropCourseHelper(CourseNode *node, int cID)
-{
-    if (node == NULL)
-        return NULL;
-    if (cID < node->data.courseID)
-    {
-        node->left = dropCourseHelper(node->left, cID);
-    }
-    else if (cID > node->data.courseID)
-    {
-        node->right = dropCourseHelper(node->right, cID);
-    }
-    else
-    {
-        if (node->left == NULL)
-        {
-            CourseNode *tmp = node->right;
-            delete node;
-            return tmp;
-        }
-        else if (node->right == NULL)
-        {
-            CourseNode *tmp = node->left;
-            delete node;
-            return tmp;
-        }
-        else
-        {
-            CourseNode *minRight = findMinCourseNode(node->right);
-            node->data = minRight->data;
-            node->right = dropCourseHelper(node->right, minRight->data.courseID);
-        }
-    }
-    return node;
-}
-
-void dropCourse(int cID)
-{
-    gCourseRoot = dropCourseHelper(gCourseRoot, cID);
-    deleteCourseHash(cID);
+        gPrereqs.forEachPrereq(courseID, print);
+    if (!first)
+        cout << "\n";
 }
 
 void displayCoursesInOrderHelper(CourseNode *node)
@@ -454,17 +120,8 @@ void displayCoursesInOrderHelper(CourseNode *node)
          << "  Instructor: " << node->data.courseInstructor << "\n"
          << "  Capacity: " << node->data.currentEnrolled
          << "/" << node->data.maxCapacity << "\n";
-    if (node->data.prereqCount > 0)
-    {
-        cout << "  Prerequisites: ";
-        for (int i = 0; i < node->data.prereqCount; i++)
-        {
-            cout << node->data.prereqIDs[i];
-            if (i < node->data.prereqCount - 1)
-                cout << ", ";
-        }
-        cout << "\n";
-    }
+    printCourseLinks("  Prerequisites: ", node->data.courseID, false);
+    printCourseLinks("  Unlocks: ", node->data.courseID, true);
     cout << "---------------------------------\n";
 
     displayCoursesInOrderHelper(node->right);
@@ -482,9 +139,9 @@ void displayCoursesInOrder()
     cout << endl;
 }
 
-Course createCourseRecord(int cID);
+Course createCourseRecord(int cID, vector<int> &prereqIDs);
 
-Course createCourseRecord(int cID)
+Course createCourseRecord(int cID, vector<int> &prereqIDs)
 {
     Course c;
     c.courseID = cID;
@@ -525,22 +182,24 @@ Course createCourseRecord(int cID)
         }
         else if (choice == 1)
         {
-            if (c.prereqCount >= Course::MAX_PREREQS)
-            {
-                cout << "Max prereqs reached.\n";
-                continue;
-            }
             cout << "Enter prerequisite Course ID: ";
             int pID;
             cin >> pID;
             if (!courseExists(pID))
             {
                 cout << "Prereq course " << pID << " doesn't exist, creating now...\n";
-                Course newPrereq = createCourseRecord(pID);
-                insertCourseBST(newPrereq);
+                vector<int> itsPrereqs;
+                Course newPrereq = createCourseRecord(pID, itsPrereqs);
+                if (!insertCourseBST(newPrereq, itsPrereqs.data(), (int)itsPrereqs.size()))
+                    continue;
+            }
+            if (gPrereqs.wouldCreateCycle(cID, pID))
+            {
+                cout << "Course " << pID << " already requires course " << cID
+                     << "; adding it would create a cycle.\n";
+                continue;
             }
-            c.prereqIDs[c.prereqCount] = pID;
-            c.prereqCount++;
+            prereqIDs.push_back(pID);
             cout << "Prerequisite " << pID << " added to course " << cID << ".\n";
         }
         else
@@ -551,395 +210,18 @@ Course createCourseRecord(int cID)
 
     return c;
 }
-void addEnrollment(int studentID, int courseID)
-{
-    if (!searchStudentByID(studentID))
-    {
-        cout << "Error: Student " << studentID << " doesn't exist.\n";
-        return;
-    }
-    if (!courseExists(courseID))
-    {
-        cout << "Error: Course " << courseID << " doesn't exist.\n";
-        return;
-    }
-    if (!meetsPrerequisites(studentID, *searchCourseByID(courseID)))
-    {
-        cout << "Student " << studentID << "\n does not meet prerequisites for course " << courseID << ".\n";
-        return;
-    }
-
-    Course *coursePtr = searchCourseByID(courseID);
-    if (coursePtr->maxCapacity > 0 && coursePtr->currentEnrolled >= coursePtr->maxCapacity)
-    {
-        cout << "Course " << courseID << " is full ("
-             << coursePtr->currentEnrolled << "/" << coursePtr->maxCapacity
-             << "). Add student " << studentID << " to the waitlist instead.\n";
-        return;
-    }
-
-    EnrollmentNode *checkPtr = gEnrollmentHead;
-    while (checkPtr)
-    {
-        if (checkPtr->data.studentID == studentID &&
-            checkPtr->data.courseID == courseID)
-        {
-            cout << "Error: Student " << studentID
-                 << " already enrolled in " << courseID << ".\n";
-            return;
-        }
-        checkPtr = checkPtr->next;
-    }
-
-    EnrollmentNode *newNode = new EnrollmentNode;
-    newNode->data.studentID = studentID;
-    newNode->data.courseID = courseID;
-    newNode->next = NULL;
-    newNode->prev = NULL;
-
-    if (!gEnrollmentHead)
-    {
-        gEnrollmentHead = gEnrollmentTail = newNode;
-    }
-    else
-    {
-        gEnrollmentTail->next = newNode;
-        newNode->prev = gEnrollmentTail;
-        gEnrollmentTail = newNode;
-    }
-    cout << "Enrollment added (student " << studentID
-         << " in course " << courseID << ").\n";
-
-    coursePtr->currentEnrolled++;
-    cout << "Enrollment added (student " << studentID
-         << " in course " << courseID << ").\n";
-}
-
-bool removeEnrollment(int studentID, int courseID)
-{
-    EnrollmentNode *cur = gEnrollmentHead;
-    while (cur)
-    {
-        if (cur->data.studentID == studentID && cur->data.courseID == courseID)
-        {
-            if (cur->prev)
-                cur->prev->next = cur->next;
-            else
-                gEnrollmentHead = cur->next;
-            if (cur->next)
-                cur->next->prev = cur->prev;
-            else
-                gEnrollmentTail = cur->prev;
-
-            Course *c = searchCourseByID(courseID);
-            if (c && c->currentEnrolled > 0)
-                c->currentEnrolled--;
-
-            delete cur;
-            cout << "Student " << studentID
-                 << " unenrolled from course " << courseID << ".\n";
-
-            return true;
-        }
-        cur = cur->next;
-    }
-    cout << "Enrollment not found.\n";
-    return false;
-}
-
 void viewEnrollment(int studentID)
 {
     cout << "\n-- Enrollment History for Student " << studentID << " --\n";
-    EnrollmentNode *cur = gEnrollmentHead;
-    bool found = false;
-    while (cur)
-    {
-        if (cur->data.studentID == studentID)
-        {
-            cout << "  Course ID: " << cur->data.courseID << "\n";
-            found = true;
-        }
-        cur = cur->next;
-    }
-    if (!found)
+    if (gEnrollments.countForStudent(studentID) == 0)
     {
         cout << "  [No enrollment records found]\n";
     }
+    gEnrollments.forEachCourseOf(studentID, [](int courseID)
+                                 { cout << "  Course ID: " << courseID << "\n"; });
     cout << "---------------------------------\n\n";
 }
 
-bool isStudentEnrolledInCourse(int studentID, int courseID)
-{
-    EnrollmentNode *cur = gEnrollmentHead;
-    while (cur)
-    {
-        if (cur->data.studentID == studentID &&
-            cur->data.courseID == courseID)
-        {
-            return true;
-        }
-        cur = cur->next;
-    }
-    return false;
-}
-
-bool pushPrereq(int val)
-{
-    if (stackTop >= MAX_STACK - 1)
-        return false;
-    stackTop++;
-    prereqStack[stackTop] = val;
-    return true;
-}
-bool popPrereq()
-{
-    if (stackTop < 0)
-        return false;
-    stackTop--;
-    return true;
-}
-int topPrereq()
-{
-    if (stackTop < 0)
-        return -1;
-    return prereqStack[stackTop];
-}
-bool isPrereqEmpty()
-{
-    return (stackTop < 0);
-}
-
-bool checkPrerequisitesWithStack(int studentID, const Course &course, bool verbose = false)
-{
-    stackTop = -1;
-
-    for (int i = 0; i < course.prereqCount; ++i)
-    {
-        if (!pushPrereq(course.prereqIDs[i]))
-        {
-            if (verbose)
-                cout << "[STACK] Overflow while pushing prereqs.\n";
-            return false;
-        }
-    }
-
-    while (!isPrereqEmpty())
-    {
-        int needed = topPrereq();
-        popPrereq();
-
-        if (!isStudentEnrolledInCourse(studentID, needed))
-        {
-            if (verbose)
-            {
-                cout << " -> Missing prerequisite: " << needed << "\n";
-            }
-            return false;
-        }
-
-        Course *pc = searchCourseByID(needed); // if a prerequisite course has prerequisites itself
-        if (pc)
-        {
-            for (int j = 0; j < pc->prereqCount; ++j)
-            {
-                if (!pushPrereq(pc->prereqIDs[j]))
-                {
-                    if (verbose)
-                        cout << "[STACK] Overflow while pushing nested prereqs.\n";
-                    return false;
-                }
-            }
-        }
-    }
-
-    if (verbose)
-    {
-        cout << " -> All prerequisites met. Registration allowed!\n";
-    }
-    return true;
-}
-
-bool meetsPrerequisites(int studentID, const Course &course)
-{
-    return checkPrerequisitesWithStack(studentID, course, false);
-}
-
-bool validatePrerequisites(int courseID, int studentID)
-{
-    Student *s = searchStudentByID(studentID);
-    if (!s)
-    {
-        cout << "Error: Student " << studentID << " doesn't exist.\n";
-        return false;
-    }
-
-    Course *c = searchCourseByID(courseID);
-    if (!c)
-    {
-        cout << "Error: Course " << courseID << " doesn't exist.\n";
-        return false;
-    }
-
-    cout << "[STACK] Checking prerequisites for course "
-         << courseID << ", student " << studentID << "...\n";
-
-    return checkPrerequisitesWithStack(studentID, *c, true);
-}
-
-bool enqueueWaitlist(int studentID, int courseID)
-{
-    if (!searchStudentByID(studentID))
-    {
-        cout << "Student doesn't exist.\n";
-        return false;
-    }
-    if (!courseExists(courseID))
-    {
-        cout << "Course doesn't exist.\n";
-        return false;
-    }
-    for (int i = 0; i < qCount; i++) //check if student is already waitlisted
-    {
-        int idx = (frontIdx + i) % MAX_Q; //circular indexing
-        if (waitlistQ[idx].studentID == studentID &&
-            waitlistQ[idx].courseID == courseID)
-        {
-            cout << "Already waitlisted.\n";
-            return false;
-        }
-    }
-    if (qCount == MAX_Q)
-    {
-        cout << "Waitlist full.\n";
-        return false;
-    }
-    rearIdx = (rearIdx + 1) % MAX_Q;
-    waitlistQ[rearIdx].studentID = studentID;
-    waitlistQ[rearIdx].courseID = courseID;
-    qCount++;
-    cout << "Student " << studentID << " waitlisted for course " << courseID << ".\n";
-    return true;
-}
-
-bool dequeueWaitlist()
-{
-    if (qCount == 0)
-    {
-        return false;
-    }
-
-    WaitlistItem w = waitlistQ[frontIdx];
-
-    Course *c = searchCourseByID(w.courseID);
-    if (!c)
-    {
-        frontIdx = (frontIdx + 1) % MAX_Q;
-        qCount--;
-        cout << "Removed invalid waitlist entry (course missing) for student "
-             << w.studentID << ".\n";
-        return true;
-    }
-
-    if (c->maxCapacity > 0 && c->currentEnrolled >= c->maxCapacity)
-    {
-        cout << "Course " << w.courseID << " is still full ("
-             << c->currentEnrolled << "/" << c->maxCapacity
-             << "). Waitlist remains unchanged.\n";
-        return false;
-    }
-
-    if (!meetsPrerequisites(w.studentID, *c))
-    {
-        cout << "Student " << w.studentID
-             << " does not meet prerequisites for course " << w.courseID
-             << ". Waitlist remains unchanged.\n";
-        return false;
-    }
-
-    frontIdx = (frontIdx + 1) % MAX_Q;
-    qCount--;
-
-    cout << "Enrolling student " << w.studentID
-         << " from waitlist in course " << w.courseID << ".\n";
-    addEnrollment(w.studentID, w.courseID);
-    return true;
-}
-
-void initCourseHashTable()
-{
-    for (int i = 0; i < TABLE_SIZE; i++)
-    {
-        courseTable[i] = NULL;
-    }
-}
-int hashFunction(int key)
-{
-    return key % TABLE_SIZE;
-}
-void insertCourseHash(Course *cPtr)
-{
-    if (!cPtr)
-        return;
-
-    int idx = hashFunction(cPtr->courseID);
-    CourseHashNode *newNode = new CourseHashNode;
-    newNode->data = cPtr;
-    newNode->next = courseTable[idx];
-    courseTable[idx] = newNode;
-}
-
-int rebuildHashFromBST(CourseNode *node)
-{
-    if (!node)
-        return 0;
-
-    int count = 0;
-
-    count += rebuildHashFromBST(node->left);
-
-    insertCourseHash(&node->data);
-
-    count += rebuildHashFromBST(node->right);
-
-    return count + 1;
-}
-
-Course *searchCourseHash(int cID)
-{
-    int idx = hashFunction(cID);
-    CourseHashNode *cur = courseTable[idx];
-    while (cur)
-    {
-        if (cur->data && cur->data->courseID == cID)
-            return cur->data;
-        cur = cur->next;
-    }
-    return NULL;
-}
-
-bool deleteCourseHash(int cID)
-{
-    int idx = hashFunction(cID);
-    CourseHashNode *cur = courseTable[idx];
-    CourseHashNode *prev = NULL;
-
-    while (cur)
-    {
-        if (cur->data && cur->data->courseID == cID)
-        {
-            if (prev)
-                prev->next = cur->next;
-            else
-                courseTable[idx] = cur->next;
-            delete cur;
-            return true;
-        }
-        prev = cur;
-        cur = cur->next;
-    }
-    return false;
-}
-
 void studentMenu()
 {
     while (true)
@@ -990,8 +272,7 @@ void studentMenu()
             int id;
             cout << "Enter ID to delete: ";
             cin >> id;
-            bool ok = deleteStudent(id);
-            if (ok)
+            if (deleteStudent(id) == OP_OK)
                 cout << "Deleted.\n";
             else
                 cout << "Not found.\n";
@@ -1042,6 +323,7 @@ void courseMenu()
              << "2. Drop Course\n"
              << "3. Display Courses (In-Order)\n"
              << "4. Search Course by ID\n"
+             << "5. Change Course Capacity\n"
              << "0. Return\n"
              << "Choice: ";
         int ch;
@@ -1067,9 +349,10 @@ void courseMenu()
                 cout << "Course " << cID << " already exists.\n";
                 continue;
             }
-            Course c = createCourseRecord(cID);
-            insertCourseBST(c);
-            cout << "Course " << cID << " added with any prerequisites.\n";
+            vector<int> prereqIDs;
+            Course c = createCourseRecord(cID, prereqIDs);
+            if (insertCourseBST(c, prereqIDs.data(), (int)prereqIDs.size()))
+                cout << "Course " << cID << " added with any prerequisites.\n";
         }
         else if (ch == 2)
         {
@@ -1096,21 +379,24 @@ void courseMenu()
                      << " Name: " << c->courseName << "\n"
                      << " Credits: " << c->courseCredits << "\n"
                      << " Instructor: " << c->courseInstructor << "\n";
-                if (c->prereqCount > 0)
-                {
-                    cout << " Prereqs: ";
-                    for (int i = 0; i < c->prereqCount; i++)
-                    {
-                        cout << c->prereqIDs[i] << (i < c->prereqCount - 1 ? ", " : "");
-                    }
-                }
-                cout << "\n\n";
+                printCourseLinks(" Prereqs: ", c->courseID, false);
+                printCourseLinks(" Unlocks: ", c->courseID, true);
+                cout << "\n";
             }
             else
             {
                 cout << "Not found.\n";
             }
         }
+        else if (ch == 5)
+        {
+            int cID, cap;
+            cout << "Enter Course ID: ";
+            cin >> cID;
+            cout << "New capacity (0 = unlimited): ";
+            cin >> cap;
+            setCourseCapacity(cID, cap);
+        }
         else
         {
             cout << "[Invalid choice]\n";
@@ -1126,6 +412,8 @@ void enrollmentMenu()
              << "1. Add Enrollment\n"
              << "2. View Enrollment by Student\n"
              << "3. Remove Enrollment (Unenroll)\n"
+             << "4. Enter Seat Lottery\n"
+             << "5. Run Seat Lottery\n"
              << "0. Return\n"
              << "Choice: ";
         int ch;
@@ -1166,7 +454,300 @@ void enrollmentMenu()
             cin >> cID;
             removeEnrollment(sID, cID);
         }
-
+        else if (ch == 4)
+        {
+            int sID, cID, standing;
+            cout << "Student ID: ";
+            cin >> sID;
+            cout << "Course ID: ";
+            cin >> cID;
+            cout << "Class standing (0-" << WAITLIST_LEVELS - 1 << ", higher draws more often): ";
+            cin >> standing;
+            if (submitLotteryRequest(sID, cID, standing) == OP_OK)
+                cout << "Entered. " << gLottery.size() << " request(s) in the current window.\n";
+        }
+        else if (ch == 5)
+        {
+            unsigned long long seed;
+            cout << gLottery.size() << " request(s) in the window. Seed: ";
+            cin >> seed;
+            LotteryReport report;
+            runSeatLottery(seed, report);
+            const size_t SHOWN = 20;
+            for (size_t i = 0; i < report.entries.size() && i < SHOWN; i++)
+            {
+                const LotteryEntry &e = report.entries[i];
+                cout << "  Course " << e.courseID << ", student " << e.studentID << ": "
+                     << (e.result == OP_OK ? "enrolled" : e.result == OP_COURSE_FULL ? "waitlisted" : opResultText(e.result))
+                     << "\n";
+            }
+            if (report.entries.size() > SHOWN)
+                cout << "  ... " << report.entries.size() - SHOWN << " more\n";
+        }
+        else
+        {
+            cout << "[Invalid choice]\n";
+        }
+    }
+}
+
+void prereqMenu()
+{
+    while (true)
+    {
+        cout << "\n*** PREREQUISITE MENU ***\n"
+             << "1. Validate (course, student)\n"
+             << "2. Show Topological Layers\n"
+             << "3. List Eligible Students (course)\n"
+             << "4. Show Courses Unlocked by (course)\n"
+             << "5. Plan Path to a Course (student, course)\n"
+             << "6. Plan Path for All Students (course)\n"
+             << "7. Audit All Enrollments\n"
+             << "0. Return\n"
+             << "Choice: ";
+        int ch;
+        cin >> ch;
+        if (!cin)
+        {
+            cin.clear();
+            cin.ignore(1000, '\n');
+            continue;
+        }
+        if (ch == 0)
+        {
+            break;
+        }
+        else if (ch == 1)
+        {
+            int cID, sID;
+            cout << "Course ID: ";
+            cin >> cID;
+            cout << "Student ID: ";
+            cin >> sID;
+            validatePrerequisites(cID, sID);
+        }
+        else if (ch == 2)
+        {
+            vector<vector<int>> layers;
+            gPrereqs.topologicalLayers(layers);
+            cout << "\n-- Courses by Prerequisite Depth --\n";
+            if (layers.empty())
+                cout << "[No courses found]\n";
+            for (size_t d = 0; d < layers.size(); d++)
+            {
+                sort(layers[d].begin(), layers[d].end());
+                cout << "Layer " << d << ":";
+                for (int id : layers[d])
+                    cout << " " << id;
+                cout << "\n";
+            }
+        }
+        else if (ch == 3)
+        {
+            int cID;
+            cout << "Course ID: ";
+            cin >> cID;
+            long count;
+            int onLine = 0;
+            auto printIDs = [&](const int *ids, int n)
+            {
+                for (int i = 0; i < n; i++)
+                {
+                    cout << (onLine ? " " : "  ") << ids[i];
+                    if (++onLine == 10)
+                    {
+                        cout << "\n";
+                        onLine = 0;
+                    }
+                }
+            };
+            findEligibleStudents(cID, &count, printIDs);
+            if (onLine)
+                cout << "\n";
+        }
+        else if (ch == 4)
+        {
+            int cID;
+            cout << "Course ID: ";
+            cin >> cID;
+            if (!courseExists(cID))
+                cout << "Course " << cID << " doesn't exist.\n";
+            else if (gPrereqs.dependantCount(cID) == 0)
+                cout << "Course " << cID << " is not a prerequisite of any course.\n";
+            else
+                printCourseLinks("Unlocks: ", cID, true);
+        }
+        else if (ch == 5)
+        {
+            int sID, cID, cap;
+            cout << "Student ID: ";
+            cin >> sID;
+            cout << "Target Course ID: ";
+            cin >> cID;
+            cout << "Credits per semester (0 = " << DEFAULT_TERM_CREDITS << "): ";
+            cin >> cap;
+            DegreePlan plan;
+            if (planDegreePath(sID, cID, cap > 0 ? cap : DEFAULT_TERM_CREDITS, plan) != OP_OK)
+                continue;
+            for (size_t t = 0; t < plan.semesters.size(); t++)
+            {
+                cout << "  Semester " << t + 1 << ":";
+                for (int id : plan.semesters[t])
+                    cout << " " << id;
+                cout << "\n";
+            }
+        }
+        else if (ch == 6)
+        {
+            int cID, cap;
+            cout << "Target Course ID: ";
+            cin >> cID;
+            cout << "Credits per semester (0 = " << DEFAULT_TERM_CREDITS << "): ";
+            cin >> cap;
+            vector<int> ids;
+            ids.reserve(gStudents.size());
+            for (const Student &st : gStudents.records)
+                ids.push_back(st.ID);
+            vector<DegreePlan> plans;
+            if (planDegreePathCohort(ids, cID, cap > 0 ? cap : DEFAULT_TERM_CREDITS, plans) != OP_OK)
+                continue;
+
+            // Students grouped by how many semesters they still need.
+            vector<int> bySemesters;
+            int blocked = 0;
+            for (const DegreePlan &p : plans)
+            {
+                if (p.result != OP_OK)
+                {
+                    blocked++;
+                    continue;
+                }
+                size_t n = p.semesters.size();
+                if (n >= bySemesters.size())
+                    bySemesters.resize(n + 1, 0);
+                bySemesters[n]++;
+            }
+            for (size_t n = 0; n < bySemesters.size(); n++)
+            {
+                if (bySemesters[n] > 0)
+                    cout << "  " << n << " semesters: " << bySemesters[n] << " students\n";
+            }
+            if (blocked > 0)
+                cout << "  No plan possible: " << blocked << " students\n";
+        }
+        else if (ch == 7)
+        {
+            AuditReport report;
+            auditPrerequisites(report);
+            const size_t SHOWN = 20;
+            for (size_t i = 0; i < report.violations.size() && i < SHOWN; i++)
+            {
+                const AuditViolation &v = report.violations[i];
+                cout << "  Student " << v.studentID << " in course " << v.courseID
+                     << " lacks prerequisite " << v.missingID << "\n";
+            }
+            if (report.violations.size() > SHOWN)
+                cout << "  ... " << report.violations.size() - SHOWN << " more\n";
+        }
+        else
+        {
+            cout << "[Invalid choice]\n";
+        }
+    }
+}
+
+void waitlistQueueMenu()
+{
+    while (true)
+    {
+        cout << "\n*** WAITLIST MENU ***\n"
+             << "1. Enqueue (student, course, priority)\n"
+             << "2. Fill a course's open seats from its waitlist\n"
+             << "3. Show a course's waitlist\n"
+             << "4. Enqueue a range of students (bulk)\n"
+             << "0. Return\n"
+             << "Choice: ";
+        int ch;
+        cin >> ch;
+        if (!cin)
+        {
+            cin.clear();
+            cin.ignore(1000, '\n');
+            continue;
+        }
+        if (ch == 0)
+        {
+            break;
+        }
+        else if (ch == 1)
+        {
+            int sID, cID, priority;
+            cout << "Student ID: ";
+            cin >> sID;
+            cout << "Course ID: ";
+            cin >> cID;
+            cout << "Priority (0-" << WAITLIST_LEVELS - 1 << ", higher is served first): ";
+            cin >> priority;
+            enqueueWaitlist(sID, cID, priority);
+        }
+        else if (ch == 2)
+        {
+            int cID;
+            cout << "Course ID: ";
+            cin >> cID;
+            if (gWaitlists.countFor(cID) == 0)
+            {
+                cout << "Waitlist empty.\n";
+            }
+            else
+            {
+                cout << promoteWaitlist(cID) << " student(s) enrolled.\n";
+            }
+        }
+        else if (ch == 3)
+        {
+            int cID;
+            cout << "Course ID: ";
+            cin >> cID;
+            cout << "Waitlist for course " << cID << " (" << gWaitlists.countFor(cID) << "):\n";
+            int pos = 0;
+            auto show = [&](const WaitlistItem &w)
+            {
+                cout << "  " << ++pos << ". Student " << w.studentID
+                     << " (priority " << w.priority << ")\n";
+            };
+            gWaitlists.forEachIn(cID, show);
+        }
+        else if (ch == 4)
+        {
+            int cID, firstID, lastID, priority;
+            cout << "Course ID: ";
+            cin >> cID;
+            cout << "First and last student ID: ";
+            cin >> firstID >> lastID;
+            cout << "Priority (0-" << WAITLIST_LEVELS - 1 << "): ";
+            cin >> priority;
+            vector<WaitlistRequest> requests;
+            for (int id = firstID; id <= lastID; id++)
+            {
+                WaitlistRequest req;
+                req.studentID = id;
+                req.courseID = cID;
+                req.priority = priority;
+                requests.push_back(req);
+            }
+            enqueueWaitlistBatch(requests);
+            int rejected = 0;
+            for (const WaitlistRequest &req : requests)
+            {
+                if (req.result != OP_OK && rejected++ < 10)
+                    cout << "  Student " << req.studentID << ": " << opResultText(req.result) << "\n";
+            }
+            if (rejected > 10)
+                cout << "  ... " << rejected - 10 << " more rejected\n";
+            if (!requests.empty() && requests.back().result == OP_OK)
+                cout << "Last student is at position " << requests.back().position << ".\n";
+        }
         else
         {
             cout << "[Invalid choice]\n";
@@ -1174,12 +755,15 @@ void enrollmentMenu()
     }
 }
 
-void prereqStackMenu()
+void hashTableMenu()
 {
     while (true)
     {
-        cout << "\n*** PREREQ STACK MENU ***\n"
-             << "1. Validate (course, student)\n"
+        cout << "\n*** COURSE HASH TABLE MENU ***\n"
+             << "1. Init Hash Table (Clear)\n"
+             << "2. Rebuild Hash from BST\n"
+             << "3. Search Course in Hash\n"
+             << "4. Show Table Stats\n"
              << "0. Return\n"
              << "Choice: ";
         int ch;
@@ -1196,12 +780,43 @@ void prereqStackMenu()
         }
         else if (ch == 1)
         {
-            int cID, sID;
-            cout << "Course ID: ";
+            initCourseHashTable();
+            cout << "Hash table cleared/initialized.\n";
+        }
+        else if (ch == 2)
+        {
+            initCourseHashTable();
+            int cnt = rebuildHashFromBST(gCourseRoot);
+            cout << "Hash table rebuilt from BST. " << cnt << " courses indexed.\n";
+        }
+        else if (ch == 3)
+        {
+            int cID;
+            cout << "Enter Course ID: ";
             cin >> cID;
-            cout << "Student ID: ";
-            cin >> sID;
-            validatePrerequisites(cID, sID);
+
+            Course *c = searchCourseHash(cID);
+            if (c)
+            {
+                cout << "\n-- Found in Hash --\n"
+                     << " ID: " << c->courseID << "\n"
+                     << " Name: " << c->courseName << "\n"
+                     << " Credits: " << c->courseCredits << "\n"
+                     << " Instructor: " << c->courseInstructor << "\n";
+                printCourseLinks(" Prereqs: ", c->courseID, false);
+                printCourseLinks(" Unlocks: ", c->courseID, true);
+                cout << "\n";
+            }
+            else
+            {
+                cout << "Not found in hash.\n";
+            }
+        }
+        else if (ch == 4)
+        {
+            cout << "Entries: " << courseTable.size()
+                 << "  Slots: " << courseTable.capacity()
+                 << (courseTable.migrating() ? "  (resize in progress)" : "") << "\n";
         }
         else
         {
@@ -1210,13 +825,13 @@ void prereqStackMenu()
     }
 }
 
-void waitlistQueueMenu()
+void memoryMenu()
 {
     while (true)
     {
-        cout << "\n*** WAITLIST MENU ***\n"
-             << "1. Enqueue (student, course)\n"
-             << "2. Dequeue\n"
+        cout << "\n*** MEMORY POOLS MENU ***\n"
+             << "1. Show Pool Stats\n"
+             << "2. Reset All Data\n"
              << "0. Return\n"
              << "Choice: ";
         int ch;
@@ -1233,19 +848,15 @@ void waitlistQueueMenu()
         }
         else if (ch == 1)
         {
-            int sID, cID;
-            cout << "Student ID: ";
-            cin >> sID;
-            cout << "Course ID: ";
-            cin >> cID;
-            enqueueWaitlist(sID, cID);
+            cout << "\n-- Memory Pools --\n";
+            printPoolStats("Students", gStudents.stats());
+            printPoolStats("Courses", gCourseNodes.stats());
+            printPoolStats("Enrollments", gEnrollments.stats());
         }
         else if (ch == 2)
         {
-            if (!dequeueWaitlist())
-            {
-                cout << "Waitlist empty.\n";
-            }
+            resetAllData();
+            cout << "All students, courses, enrollments and waitlist entries cleared.\n";
         }
         else
         {
@@ -1254,14 +865,13 @@ void waitlistQueueMenu()
     }
 }
 
-void hashTableMenu()
+void snapshotMenu()
 {
     while (true)
     {
-        cout << "\n*** COURSE HASH TABLE MENU ***\n"
-             << "1. Init Hash Table (Clear)\n"
-             << "2. Rebuild Hash from BST\n"
-             << "3. Search Course in Hash\n"
+        cout << "\n*** SNAPSHOT MENU ***\n"
+             << "1. Save Snapshot (" << SNAPSHOT_PATH << ")\n"
+             << "2. Revert to Snapshot (" << SNAPSHOT_PATH << ")\n"
              << "0. Return\n"
              << "Choice: ";
         int ch;
@@ -1278,45 +888,13 @@ void hashTableMenu()
         }
         else if (ch == 1)
         {
-            initCourseHashTable();
-            cout << "Hash table cleared/initialized.\n";
+            if (checkpointDatabase(false))
+                cout << "Snapshot saved to " << SNAPSHOT_PATH << " (" << gStudents.size() << " students, "
+                     << courseTable.size() << " courses, " << gEnrollments.size() << " enrollments).\n";
         }
         else if (ch == 2)
         {
-            initCourseHashTable();
-            int cnt = rebuildHashFromBST(gCourseRoot);
-            cout << "Hash table rebuilt from BST. " << cnt << " courses indexed.\n";
-        }
-        else if (ch == 3)
-        {
-            int cID;
-            cout << "Enter Course ID: ";
-            cin >> cID;
-
-            Course *c = searchCourseHash(cID);
-            if (c)
-            {
-                cout << "\n-- Found in Hash --\n"
-                     << " ID: " << c->courseID << "\n"
-                     << " Name: " << c->courseName << "\n"
-                     << " Credits: " << c->courseCredits << "\n"
-                     << " Instructor: " << c->courseInstructor << "\n";
-                if (c->prereqCount > 0)
-                {
-                    cout << " Prereqs: ";
-                    for (int i = 0; i < c->prereqCount; i++)
-                    {
-                        cout << c->prereqIDs[i];
-                        if (i < c->prereqCount - 1)
-                            cout << ", ";
-                    }
-                }
-                cout << "\n\n";
-            }
-            else
-            {
-                cout << "Not found in hash.\n";
-            }
+            revertToSnapshot();
         }
         else
         {
@@ -1325,6 +903,43 @@ void hashTableMenu()
     }
 }
 
+void importMenu()
+{
+    string studentsPath, coursesPath, enrollmentsPath;
+    cin.ignore(1000, '\n');
+    cout << "\n*** BULK IMPORT (CSV/TSV) ***\n"
+         << "Leave a path empty to skip that file.\n";
+    cout << "Students file: ";
+    getline(cin, studentsPath);
+    cout << "Courses file: ";
+    getline(cin, coursesPath);
+    cout << "Enrollments file: ";
+    getline(cin, enrollmentsPath);
+    bulkImport(studentsPath.c_str(), coursesPath.c_str(), enrollmentsPath.c_str());
+}
+
+// Serves the core over HTTP until Enter is pressed; menus stay out of the
+// way meanwhile so the server owns the data.
+void apiServerMenu()
+{
+    ApiServerConfig config;
+    cout << "\n*** API SERVER (localhost) ***\n"
+         << "Port (8080): ";
+    string line;
+    cin.ignore(1000, '\n');
+    getline(cin, line);
+    if (!line.empty())
+        config.port = atoi(line.c_str());
+    if (!startApiServer(config))
+        return;
+    cout << "Serving on http://127.0.0.1:" << config.port << ". Press Enter to stop.\n";
+    getline(cin, line);
+    stopApiServer();
+    ApiServerStats st = apiServerStats();
+    cout << "Requests: " << st.requests << ", connections: " << st.connections << ", errors: " << st.errors
+         << ", checkpoints: " << st.checkpoints << "\n";
+}
+
 enum ScreenID
 {
     SCR_MAIN,
@@ -1339,22 +954,29 @@ enum ScreenID
 
 int consoleMain()
 {
+    ConsoleSink console;
+    ScopedMessageSink useConsole(&console);
     try
     {
         while (true)
         {
             cout << "\n=========== MAIN MENU ===========\n"
-                 << "1. Manage Students (SLL)\n"
-                 << "2. Manage Courses (BST)\n"
-                 << "3. Manage Enrollments (DLL)\n"
-                 << "4. Registration (Prereq Stack)\n"
+                 << "1. Manage Students (Hashed Array)\n"
+                 << "2. Manage Courses (AVL)\n"
+                 << "3. Manage Enrollments (Indexed)\n"
+                 << "4. Registration (Prereq Closure)\n"
                  << "5. Waitlist (Queue)\n"
-                 << "6. Course Hash Table (Chaining)\n"
+                 << "6. Course Hash Table (Open Addressing)\n"
+                 << "7. Memory Pools\n"
+                 << "8. Save / Load Snapshot\n"
+                 << "9. Bulk Import (CSV/TSV)\n"
+                 << "10. API Server (localhost)\n"
                  << "0. Exit\n"
                  << "=================================\n"
                  << "Enter your choice: ";
             int mainChoice;
             cin >> mainChoice;
+            journalMaintenance();
 
             if (!cin)
             {
@@ -1382,7 +1004,7 @@ int consoleMain()
             }
             else if (mainChoice == 4)
             {
-                prereqStackMenu();
+                prereqMenu();
             }
             else if (mainChoice == 5)
             {
@@ -1392,6 +1014,22 @@ int consoleMain()
             {
                 hashTableMenu();
             }
+            else if (mainChoice == 7)
+            {
+                memoryMenu();
+            }
+            else if (mainChoice == 8)
+            {
+                snapshotMenu();
+            }
+            else if (mainChoice == 9)
+            {
+                importMenu();
+            }
+            else if (mainChoice == 10)
+            {
+                apiServerMenu();
+            }
             else
             {
                 cout << "[Invalid choice]\n";
@@ -1653,6 +1291,28 @@ static void ShowToast(const string &s)
     toastTimer = 2.0f;
 }
 
+// Keeps the last core message of the current frame so a failed operation can
+// explain itself in a toast instead of on stdout.
+class ToastSink : public MessageSink
+{
+public:
+    string last;
+
+    void write(const char *msg, size_t len) override { last.assign(msg, len); }
+};
+
+static ToastSink gToastSink;
+
+static void ShowResultToast(OpResult r, const char *okText)
+{
+    if (r == OP_OK)
+        ShowToast(okText);
+    else if (!gToastSink.last.empty())
+        ShowToast(gToastSink.last);
+    else
+        ShowToast(opResultText(r));
+}
+
 static void DrawTopBar() // header bar
 {
     int sw = GetScreenWidth();
@@ -1834,14 +1494,17 @@ static void ScreenStudents()
         }
         else
         {
-            addStudent(toInt(id.text), name.text, email.text, phone.text, addr.text, pass.text);
-            id.text.clear();
-            name.text.clear();
-            email.text.clear();
-            phone.text.clear();
-            addr.text.clear();
-            pass.text.clear();
-            ShowToast("Student added successfully");
+            OpResult r = addStudent(toInt(id.text), name.text, email.text, phone.text, addr.text, pass.text);
+            if (r == OP_OK)
+            {
+                id.text.clear();
+                name.text.clear();
+                email.text.clear();
+                phone.text.clear();
+                addr.text.clear();
+                pass.text.clear();
+            }
+            ShowResultToast(r, "Student added successfully");
         }
     }
 
@@ -1905,8 +1568,7 @@ static void ScreenStudents()
 
     if (DrawButton(deleteBtn))
     {
-        bool ok = deleteStudent(toInt(searchId.text));
-        ShowToast(ok ? "Student deleted" : "Not found");
+        ShowResultToast(deleteStudent(toInt(searchId.text)), "Student deleted");
         searchId.text.clear();
     }
 
@@ -1948,12 +1610,12 @@ static void ScreenStudents()
 
     tblY += ScaleY(35);
     int row = 0;
-    StudentNode *cur = gStudentHead;
     int dataRowHeight = ScaleY(28);
     int dataSize = ScaleSize(15);
 
-    while (cur && row < 9)
+    while (row < gStudents.size() && row < 9)
     {
+        const Student &cur = gStudents.records[row];
         Color rowBg = (row % 2 == 0) ? Color{30, 41, 59, 150} : Color{30, 41, 59, 50};
         DrawRectangle(startX + ScaleX(20),
                       tblY,
@@ -1961,18 +1623,17 @@ static void ScreenStudents()
                       dataRowHeight,
                       rowBg);
 
-        DrawText(TextFormat("%d", cur->data.ID),
+        DrawText(TextFormat("%d", cur.ID),
                  startX + ScaleX(30), tblY + ScaleY(6), dataSize, UI_TEXT);
-        DrawText(cur->data.Name.c_str(),
+        DrawText(cur.Name.c_str(),
                  startX + ScaleX(100), tblY + ScaleY(6), dataSize, UI_TEXT);
-        DrawText(cur->data.Email.c_str(),
+        DrawText(cur.Email.c_str(),
                  startX + ScaleX(350), tblY + ScaleY(6), dataSize, UI_TEXT);
-        DrawText(cur->data.Phone.c_str(),
+        DrawText(cur.Phone.c_str(),
                  startX + ScaleX(620), tblY + ScaleY(6), dataSize, UI_TEXT);
 
         tblY += dataRowHeight;
         row++;
-        cur = cur->next;
     }
 }
 
@@ -2167,6 +1828,29 @@ static void ScreenCourses()
         scid.text.clear();
     }
 
+    static TextBox newCap;
+    newCap.numericOnly = true;
+    newCap.maxLen = 4;
+    newCap.r = {
+        (float)(startX + ScaleX(420)),
+        (float)ScaleY(290),
+        (float)ScaleX(90),
+        (float)ScaleY(38)};
+    DrawTextBox(newCap, "Cap");
+
+    Button capBtn = {
+        {(float)(startX + ScaleX(520)),
+         (float)ScaleY(290),
+         (float)ScaleX(130),
+         (float)ScaleY(38)},
+        "Set Capacity",
+        false};
+    if (DrawButton(capBtn))
+    {
+        ShowResultToast(setCourseCapacity(toInt(scid.text), toInt(newCap.text)), "Capacity updated");
+        newCap.text.clear();
+    }
+
     Rectangle prereqCard = {
         (float)startX,
         (float)ScaleY(360),
@@ -2220,51 +1904,7 @@ static void ScreenCourses()
         false};
     if (DrawButton(addPreBtn))
     {
-        int courseID = toInt(pcid.text);
-        int prereqID = toInt(ppID.text);
-
-        Course *course = searchCourseByID(courseID);
-        if (!course)
-        {
-            ShowToast("Course not found");
-        }
-        else if (courseID == prereqID)
-        {
-            ShowToast("Course cannot be its own prerequisite");
-        }
-        else
-        {
-            Course *prCourse = searchCourseByID(prereqID);
-            if (!prCourse)
-            {
-                ShowToast("Prereq course must exist first");
-            }
-            else if (course->prereqCount >= Course::MAX_PREREQS)
-            {
-                ShowToast("Max prerequisites reached for this course");
-            }
-            else
-            {
-                bool already = false;
-                for (int i = 0; i < course->prereqCount; ++i)
-                {
-                    if (course->prereqIDs[i] == prereqID)
-                    {
-                        already = true;
-                        break;
-                    }
-                }
-
-                if (already)
-                    ShowToast("Prerequisite already added");
-                else
-                {
-                    course->prereqIDs[course->prereqCount] = prereqID;
-                    course->prereqCount++;
-                    ShowToast("Prerequisite added");
-                }
-            }
-        }
+        ShowResultToast(addPrerequisite(toInt(pcid.text), toInt(ppID.text)), "Prerequisite added");
 
         pcid.text.clear();
         ppID.text.clear();
@@ -2393,9 +2033,11 @@ static void ScreenCourses()
                  ScaleSize(12),
                  UI_TEXT);
 
-        if (n->data.prereqCount > 0)
+        int prereqs = gPrereqs.prereqCount(n->data.courseID);
+        int unlocks = gPrereqs.dependantCount(n->data.courseID);
+        if (prereqs > 0 || unlocks > 0)
         {
-            DrawText(TextFormat("Prerequisites: %d", n->data.prereqCount),
+            DrawText(TextFormat("Prerequisites: %d  Unlocks: %d", prereqs, unlocks),
                      textX,
                      textY + ScaleY(80),
                      ScaleSize(11),
@@ -2456,35 +2098,7 @@ static void ScreenEnroll()
 
     if (DrawButton(enrollBtn))
     {
-        int s = toInt(sid.text);
-        int c = toInt(cid.text);
-
-        Student *studentPtr = searchStudentByID(s);
-        Course *coursePtr = searchCourseByID(c);
-
-        if (!studentPtr)
-        {
-            ShowToast("Student not found");
-        }
-        else if (!coursePtr)
-        {
-            ShowToast("Course not found");
-        }
-        else if (!meetsPrerequisites(s, *coursePtr))
-        {
-            ShowToast("Prerequisites not met");
-        }
-        else if (coursePtr->maxCapacity > 0 &&
-                 coursePtr->currentEnrolled >= coursePtr->maxCapacity)
-        {
-            ShowToast(TextFormat("Course %d is full (%d/%d). Add student to waitlist.",
-                                 c, coursePtr->currentEnrolled, coursePtr->maxCapacity));
-        }
-        else
-        {
-            addEnrollment(s, c);
-            ShowToast("Enrollment processed");
-        }
+        ShowResultToast(addEnrollment(toInt(sid.text), toInt(cid.text)), "Enrollment processed");
 
         sid.text.clear();
         cid.text.clear();
@@ -2555,8 +2169,7 @@ static void ScreenEnroll()
 
     if (DrawButton(dropBtn))
     {
-        bool ok = removeEnrollment(toInt(dsid.text), toInt(dcid.text));
-        ShowToast(ok ? "Enrollment dropped" : "Enrollment not found");
+        ShowResultToast(removeEnrollment(toInt(dsid.text), toInt(dcid.text)), "Enrollment dropped");
         dsid.text.clear();
         dcid.text.clear();
     }
@@ -2582,6 +2195,54 @@ static void ScreenEnroll()
              ScaleSize(14), UI_MUTED);
 }
 
+// Background prerequisite audit started from the prerequisite screen. The job
+// audits its own copy of the data, so the GUI keeps editing meanwhile.
+static AuditJob *gAuditJob = NULL;
+static thread gAuditThread;
+static atomic<bool> gAuditDone(false);
+static AuditReport gAuditReport;
+static string gAuditSummary;
+
+static void AuditJobMain()
+{
+    gAuditJob->run(gAuditReport);
+    gAuditDone = true;
+}
+
+static void StartAuditJob()
+{
+    gAuditJob = new AuditJob();
+    gAuditJob->capture();
+    gAuditDone = false;
+    gAuditSummary = "Audit running...";
+    gAuditThread = thread(AuditJobMain);
+}
+
+static void FinishAuditJob() // joins the job once it is done, or unconditionally at exit
+{
+    if (!gAuditJob)
+        return;
+    gAuditThread.join();
+    delete gAuditJob;
+    gAuditJob = NULL;
+
+    gAuditSummary = TextFormat("%ld enrollments, %d violations (%.2fs)",
+                               gAuditReport.enrollmentsChecked,
+                               (int)gAuditReport.violations.size(), gAuditReport.seconds);
+    for (size_t i = 0; i < gAuditReport.violations.size() && i < 3; i++)
+    {
+        const AuditViolation &v = gAuditReport.violations[i];
+        gAuditSummary += TextFormat("  |  %d in %d lacks %d", v.studentID, v.courseID, v.missingID);
+    }
+    ShowToast(TextFormat("Audit finished: %d violations", (int)gAuditReport.violations.size()));
+}
+
+static void PollAuditJob()
+{
+    if (gAuditJob && gAuditDone)
+        FinishAuditJob();
+}
+
 static void ScreenPrereq()
 {
     DrawTopBar();
@@ -2636,33 +2297,158 @@ static void ScreenPrereq()
 
     Button validateBtn = {
         {(float)(startX + ScaleX(410)), (float)ScaleY(225),
-         (float)ScaleX(170), (float)ScaleY(38)},
+         (float)ScaleX(100), (float)ScaleY(38)},
         "Validate"};
+    Button planBtn = {
+        {(float)(startX + ScaleX(520)), (float)ScaleY(225),
+         (float)ScaleX(100), (float)ScaleY(38)},
+        "Plan Path"};
 
+    static string planLine; // semesters of the last plan
     if (DrawButton(validateBtn))
     {
-        validatePrerequisites(toInt(cid.text), toInt(sid.text));
-        ShowToast("Check console for results");
+        ShowResultToast(validatePrerequisites(toInt(cid.text), toInt(sid.text)), "All prerequisites met");
         cid.text.clear();
         sid.text.clear();
     }
+    if (DrawButton(planBtn))
+    {
+        DegreePlan plan;
+        OpResult r = planDegreePath(toInt(sid.text), toInt(cid.text), DEFAULT_TERM_CREDITS, plan);
+        planLine.clear();
+        for (size_t t = 0; t < plan.semesters.size() && r == OP_OK; t++)
+        {
+            planLine += TextFormat("%sS%d:", t ? "  " : "", (int)t + 1);
+            for (int id : plan.semesters[t])
+                planLine += TextFormat(" %d", id);
+        }
+        if (planLine.size() > 90)
+            planLine = planLine.substr(0, 87) + "...";
+        ShowResultToast(r, gToastSink.last.c_str());
+    }
 
-    Rectangle infoBox = {
+    DrawText(planLine.c_str(),
+             startX + ScaleX(20),
+             ScaleY(275),
+             ScaleSize(14),
+             UI_MUTED);
+
+    Rectangle eligCard = {
         (float)startX,
         (float)ScaleY(320),
         (float)contentWidth,
+        (float)ScaleY(150)};
+    DrawRectangleRounded(eligCard, 0.02f, 8, UI_CARD);
+    DrawRectangleRoundedLines(eligCard, 0.02f, 8, 1.0f, Color{71, 85, 105, 255});
+
+    DrawText("Eligible Students",
+             startX + ScaleX(20),
+             ScaleY(335),
+             ScaleSize(18),
+             UI_TEXT);
+
+    static TextBox ecid;
+    static string eligibleLine; // summary of the last query
+    ecid.numericOnly = true;
+    ecid.maxLen = 16;
+    ecid.r = {(float)(startX + ScaleX(20)), (float)ScaleY(385),
+              (float)ScaleX(180), (float)ScaleY(38)};
+
+    DrawText("Course ID",
+             startX + ScaleX(20),
+             ScaleY(365),
+             ScaleSize(15),
+             UI_MUTED);
+    DrawTextBox(ecid, "501");
+
+    Button eligBtn = {
+        {(float)(startX + ScaleX(210)), (float)ScaleY(385),
+         (float)ScaleX(170), (float)ScaleY(38)},
+        "Find Eligible"};
+
+    if (DrawButton(eligBtn))
+    {
+        const int SHOWN = 12;
+        vector<int> firstIDs;
+        auto keepFirst = [&](const int *ids, int n)
+        {
+            for (int i = 0; i < n && (int)firstIDs.size() < SHOWN; i++)
+                firstIDs.push_back(ids[i]);
+        };
+        long count;
+        OpResult r = findEligibleStudents(toInt(ecid.text), &count, keepFirst);
+        if (r == OP_OK)
+        {
+            eligibleLine = TextFormat("%ld eligible:", count);
+            for (int id : firstIDs)
+                eligibleLine += TextFormat(" %d", id);
+            if (count > SHOWN)
+                eligibleLine += " ...";
+            ShowToast(TextFormat("%ld students eligible", count));
+        }
+        else
+        {
+            eligibleLine.clear();
+            ShowResultToast(r, "");
+        }
+    }
+
+    DrawText(eligibleLine.c_str(),
+             startX + ScaleX(20),
+             ScaleY(438),
+             ScaleSize(15),
+             UI_MUTED);
+
+    Rectangle auditCard = {
+        (float)startX,
+        (float)ScaleY(490),
+        (float)contentWidth,
+        (float)ScaleY(110)};
+    DrawRectangleRounded(auditCard, 0.02f, 8, UI_CARD);
+    DrawRectangleRoundedLines(auditCard, 0.02f, 8, 1.0f, Color{71, 85, 105, 255});
+
+    DrawText("Enrollment Audit",
+             startX + ScaleX(20),
+             ScaleY(505),
+             ScaleSize(18),
+             UI_TEXT);
+
+    Button auditBtn = {
+        {(float)(startX + ScaleX(20)), (float)ScaleY(535),
+         (float)ScaleX(170), (float)ScaleY(38)},
+        "Run Audit"};
+
+    if (DrawButton(auditBtn))
+    {
+        if (gAuditJob)
+            ShowToast("Audit already running");
+        else
+            StartAuditJob();
+    }
+
+    string auditLine = gAuditSummary.size() > 70 ? gAuditSummary.substr(0, 67) + "..." : gAuditSummary;
+    DrawText(auditLine.c_str(),
+             startX + ScaleX(210),
+             ScaleY(547),
+             ScaleSize(14),
+             UI_MUTED);
+
+    Rectangle infoBox = {
+        (float)startX,
+        (float)ScaleY(620),
+        (float)contentWidth,
         (float)ScaleY(70)};
     DrawRectangleRounded(infoBox, 0.02f, 8, Color{59, 130, 246, 30});
     DrawRectangleRoundedLines(infoBox, 0.02f, 8, 1.0f, Color{59, 130, 246, 100});
 
     DrawText("i",
-             startX + ScaleX(20), ScaleY(340),
+             startX + ScaleX(20), ScaleY(640),
              ScaleSize(24), UI_ACCENT);
-    DrawText("Uses a stack to recursively verify prerequisites.",
-             startX + ScaleX(60), ScaleY(340),
+    DrawText("Checks the course's precomputed prerequisite closure.",
+             startX + ScaleX(60), ScaleY(640),
              ScaleSize(14), UI_MUTED);
-    DrawText("Full validation results appear in the console.",
-             startX + ScaleX(60), ScaleY(360),
+    DrawText("A missing prerequisite is reported in the notification.",
+             startX + ScaleX(60), ScaleY(660),
              ScaleSize(14), UI_MUTED);
 }
 
@@ -2691,16 +2477,20 @@ static void ScreenWaitlist()
              startX + ScaleX(20), ScaleY(175),
              ScaleSize(19), UI_TEXT);
 
-    static TextBox sid, cid;
+    static TextBox sid, cid, prio;
     sid.numericOnly = true;
     sid.maxLen = 16;
     cid.numericOnly = true;
     cid.maxLen = 16;
+    prio.numericOnly = true;
+    prio.maxLen = 1;
 
     sid.r = {(float)(startX + ScaleX(20)), (float)ScaleY(225),
-             (float)ScaleX(180), (float)ScaleY(38)};
-    cid.r = {(float)(startX + ScaleX(210)), (float)ScaleY(225),
-             (float)ScaleX(180), (float)ScaleY(38)};
+             (float)ScaleX(150), (float)ScaleY(38)};
+    cid.r = {(float)(startX + ScaleX(180)), (float)ScaleY(225),
+             (float)ScaleX(150), (float)ScaleY(38)};
+    prio.r = {(float)(startX + ScaleX(340)), (float)ScaleY(225),
+              (float)ScaleX(70), (float)ScaleY(38)};
 
     DrawText("Student ID",
              startX + ScaleX(20), ScaleY(207),
@@ -2708,31 +2498,47 @@ static void ScreenWaitlist()
     DrawTextBox(sid, "1001");
 
     DrawText("Course ID",
-             startX + ScaleX(210), ScaleY(207),
+             startX + ScaleX(180), ScaleY(207),
              ScaleSize(15), UI_MUTED);
     DrawTextBox(cid, "501");
 
+    DrawText("Priority",
+             startX + ScaleX(340), ScaleY(207),
+             ScaleSize(15), UI_MUTED);
+    DrawTextBox(prio, "0");
+
     Button addBtn = {
-        {(float)(startX + ScaleX(410)), (float)ScaleY(225),
+        {(float)(startX + ScaleX(420)), (float)ScaleY(225),
          (float)ScaleX(90), (float)ScaleY(38)},
         "Add"};
     if (DrawButton(addBtn))
     {
-        enqueueWaitlist(toInt(sid.text), toInt(cid.text));
-        ShowToast("Added to waitlist");
+        ShowResultToast(enqueueWaitlist(toInt(sid.text), toInt(cid.text), toInt(prio.text)),
+                        "Added to waitlist");
     }
 
     Button procBtn = {
-        {(float)(startX + ScaleX(510)), (float)ScaleY(225),
+        {(float)(startX + ScaleX(520)), (float)ScaleY(225),
          (float)ScaleX(90), (float)ScaleY(38)},
         "Process",
         false};
     if (DrawButton(procBtn))
     {
-        bool ok = dequeueWaitlist();
-        ShowToast(ok ? "Student enrolled" : "Waitlist empty");
+        int courseID = toInt(cid.text);
+        if (!courseExists(courseID))
+            ShowToast("Course doesn't exist");
+        else if (gWaitlists.countFor(courseID) == 0)
+            ShowToast("Waitlist is empty");
+        else
+            ShowToast(TextFormat("%d student(s) enrolled", promoteWaitlist(courseID)));
     }
 
+    int shownCourse = toInt(cid.text);
+    DrawText(TextFormat("Course %d: %d waiting, %d across all courses",
+                        shownCourse, gWaitlists.countFor(shownCourse), gWaitlists.size()),
+             startX + ScaleX(20), ScaleY(272),
+             ScaleSize(14), UI_MUTED);
+
     Rectangle infoBox = {
         (float)startX,
         (float)ScaleY(320),
@@ -2744,10 +2550,10 @@ static void ScreenWaitlist()
     DrawText("i",
              startX + ScaleX(20), ScaleY(340),
              ScaleSize(24), UI_SUCCESS);
-    DrawText("Waitlist operates as a FIFO queue. Process dequeues the next student.",
+    DrawText("Each course has its own queue; higher priorities go first, FIFO within one.",
              startX + ScaleX(60), ScaleY(340),
              ScaleSize(14), UI_MUTED);
-    DrawText("Check console for detailed enrollment messages.",
+    DrawText("Freed seats are filled automatically; Process retries the course above.",
              startX + ScaleX(60), ScaleY(360),
              ScaleSize(14), UI_MUTED);
 }
@@ -2834,7 +2640,8 @@ static void ScreenHash()
     DrawText("Hash Table Implementation",
              startX + ScaleX(60), ScaleY(380),
              ScaleSize(16), UI_TEXT);
-    DrawText("Uses chaining collision resolution with a table size of 10.",
+    DrawText(TextFormat("Open addressing, grows incrementally (%d courses, %d slots).",
+                        courseTable.size(), courseTable.capacity()),
              startX + ScaleX(60), ScaleY(405),
              ScaleSize(14), UI_MUTED);
     DrawText("Courses are indexed as they are added; 'Rebuild Hash' syncs from the BST.",
@@ -2907,6 +2714,23 @@ static void ScreenMain()
     {
         consoleMain();
     }
+
+    int sideW = 130;
+    Rectangle saveCard = {(float)(centerX - cardW / 2 - gap - sideW), (float)startY, (float)sideW, (float)cardH};
+    DrawRectangleRounded(saveCard, 0.08f, 8, UI_CARD);
+    DrawRectangleRoundedLines(saveCard, 0.08f, 8, 1.5f, Color{71, 85, 105, 255});
+    if (DrawButton({{saveCard.x + 10, (float)startY + 15, (float)(sideW - 20), (float)(cardH - 30)}, "Save", false}))
+    {
+        ShowToast(checkpointDatabase(false) ? "Data saved" : "Save failed");
+    }
+
+    Rectangle loadCard = {(float)(centerX + cardW / 2 + gap), (float)startY, (float)sideW, (float)cardH};
+    DrawRectangleRounded(loadCard, 0.08f, 8, UI_CARD);
+    DrawRectangleRoundedLines(loadCard, 0.08f, 8, 1.5f, Color{71, 85, 105, 255});
+    if (DrawButton({{loadCard.x + 10, (float)startY + 15, (float)(sideW - 20), (float)(cardH - 30)}, "Load", false}))
+    {
+        ShowToast(revertToSnapshot() ? "Reverted to last save" : "Load failed");
+    }
 }
 
 int main()
@@ -2915,13 +2739,17 @@ int main()
 
     initCourseHashTable();
 
+    recoverDatabase();
+
     InitWindow(1280, 820, "University Management System");
     SetWindowMinSize(960, 640);
 
     SetTargetFPS(60);
 
+    ScopedMessageSink useToasts(&gToastSink);
     while (!WindowShouldClose())
     {
+        gToastSink.last.clear();
         BeginDrawing();
         DrawBackground();
 
@@ -2973,9 +2801,15 @@ int main()
                 current = SCR_MAIN;
         }
 
+        PollAuditJob();
         DrawToast();
         EndDrawing();
+
+        journalMaintenance();
     }
     CloseWindow();
+
+    FinishAuditJob();
+    shutdownDatabase();
     return 0;
 }
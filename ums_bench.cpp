@@ -0,0 +1,314 @@
+// Micro-benchmarks for the headless core. Each hot operation is timed at several
+// dataset sizes and reported as ns/op and heap allocations/op. Build together
+// with the other ums_*.cpp files (no raylib), e.g.
+//   g++ -O2 -std=c++17 ums_bench.cpp ums_core.cpp ums_prereq.cpp ums_storage.cpp -o ums_bench -pthread
+// Pass sizes on the command line to override the default 1k/100k/1M runs.
+#include "ums_core.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+
+// Every global allocation goes through here so the benchmarks can count them.
+// Parallel operations allocate from worker threads, hence the atomic.
+static atomic<long long> gAllocCount(0);
+
+void *operator new(size_t n)
+{
+    gAllocCount.fetch_add(1, memory_order_relaxed);
+    void *p = malloc(n ? n : 1);
+    if (!p)
+        throw bad_alloc();
+    return p;
+}
+
+// Kept out of line: once inlined, GCC pairs the caller's operator new with
+// free() and warns (-Wmismatched-new-delete).
+__attribute__((noinline)) void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+__attribute__((noinline)) void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+class BenchTimer
+{
+public:
+    chrono::steady_clock::time_point start;
+    long long allocsAtStart;
+    double nanos = 0;
+    long long allocs = 0;
+
+    void begin()
+    {
+        allocsAtStart = gAllocCount;
+        start = chrono::steady_clock::now();
+    }
+
+    void end()
+    {
+        nanos += chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+        allocs += gAllocCount - allocsAtStart;
+    }
+};
+
+static void report(const char *name, long n, const BenchTimer &t)
+{
+    printf("%-30s %10ld %12.1f %12.2f\n", name, n, t.nanos / n, (double)t.allocs / n);
+}
+
+// Deterministic pseudo-random stream so every run touches the same keys.
+static unsigned int benchRand(unsigned int &state)
+{
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+// Courses 1..n form chains of four: course k requires k-1 unless k % 4 == 1,
+// so chain heads (1, 5, 9, ...) have no prerequisites.
+static int chainHead(unsigned int r, long n)
+{
+    return (int)(r % (unsigned int)(n / 4)) * 4 + 1;
+}
+
+// Erases keys while a resize is still migrating (an old table of 2048 slots
+// takes 32 steps), then checks that no erased key can be found again and
+// that every survivor still maps to its own value.
+static void checkMigratingErase()
+{
+    FlatIdMap<int> map;
+    const int n = 1440; // the 1434th insert grows 2048 -> 4096 slots
+    for (int k = 0; k < n; k++)
+        map.insert(k, k);
+    if (!map.migrating())
+        printf("  (FlatIdMap: expected a migration in progress after %d inserts)\n", n);
+
+    long wrong = 0;
+    for (int k = 0; k < n; k += 2)
+    {
+        map.erase(k);
+        wrong += map.find(k) != NULL;
+    }
+    map.finishMigration();
+    for (int k = 0; k < n; k++)
+    {
+        const int *v = map.find(k);
+        wrong += (k % 2 == 0) ? v != NULL : (!v || *v != k);
+    }
+    if (wrong || map.size() != n / 2)
+        printf("  (FlatIdMap: %ld wrong lookups after erasing during a migration, size %d)\n", wrong, map.size());
+}
+
+static void runScale(long n)
+{
+    resetAllData();
+    unsigned int seed = 12345;
+
+    BenchTimer addStudentT;
+    addStudentT.begin();
+    for (long i = 1; i <= n; i++)
+        addStudent((int)i, "Student", "student@uni.edu", "555-0100", "Campus", "secret");
+    addStudentT.end();
+    report("addStudent", n, addStudentT);
+
+    for (long k = 1; k <= n; k++)
+    {
+        Course c;
+        c.courseID = (int)k;
+        c.courseName = "Course";
+        c.courseCredits = 3;
+        c.courseInstructor = "Staff";
+        c.maxCapacity = 0; // unlimited
+        c.currentEnrolled = 0;
+        int prereq = (int)(k - 1);
+        insertCourseBST(c, &prereq, k % 4 != 1 ? 1 : 0);
+    }
+
+    vector<int> keys(n);
+    for (long i = 0; i < n; i++)
+        keys[i] = (int)(benchRand(seed) % (unsigned int)n) + 1;
+    BenchTimer searchT;
+    long found = 0;
+    searchT.begin();
+    for (long i = 0; i < n; i++)
+        found += searchCourseByID(keys[i]) != NULL;
+    searchT.end();
+    if (found != n)
+        printf("  (searchCourseByID missed %ld keys)\n", n - found);
+    report("searchCourseByID", n, searchT);
+
+    // Student i takes chain head heads[i]; the checks then ask for the next
+    // course in that chain (met) or the last one (missing prerequisite).
+    vector<int> heads(n);
+    for (long i = 0; i < n; i++)
+        heads[i] = chainHead(benchRand(seed), n);
+    BenchTimer enrollT;
+    enrollT.begin();
+    for (long i = 0; i < n; i++)
+        addEnrollment((int)i + 1, heads[i]);
+    enrollT.end();
+    report("addEnrollment", n, enrollT);
+
+    BenchTimer prereqT;
+    long met = 0;
+    prereqT.begin();
+    for (long i = 0; i < n; i++)
+    {
+        Course *c = searchCourseByID(heads[i] + ((i & 1) ? 3 : 1));
+        met += checkPrerequisites((int)i + 1, *c);
+    }
+    prereqT.end();
+    if (met != (n + 1) / 2)
+        printf("  (checkPrerequisites: %ld of %ld met, expected %ld)\n", met, n, (n + 1) / 2);
+    report("checkPrerequisites", n, prereqT);
+
+    // One course against every student: the closure is fetched once and each
+    // student costs a single subset test.
+    vector<int> cohort(n);
+    for (long i = 0; i < n; i++)
+        cohort[i] = (int)i + 1;
+    vector<char> eligible(n);
+    BenchTimer cohortT;
+    cohortT.begin();
+    gPrereqs.satisfiedCohort(*searchCourseByID(heads[0] + 1), cohort.data(), (int)n, eligible.data());
+    cohortT.end();
+    report("satisfiedCohort (per student)", n, cohortT);
+
+    BenchTimer eligibleT;
+    long eligibleCount;
+    eligibleT.begin();
+    findEligibleStudents(heads[0] + 1, &eligibleCount);
+    eligibleT.end();
+    report("findEligibleStudents (per st.)", n, eligibleT);
+
+    // Every student joins the waitlist of a chain head they have not taken,
+    // then each entry is processed from its own course's queue.
+    vector<int> waitCourse(n);
+    BenchTimer enqueueT;
+    enqueueT.begin();
+    for (long s = 0; s < n; s++)
+    {
+        int head = chainHead(benchRand(seed), n);
+        if (head == heads[s])
+            head = (head + 4 <= n) ? head + 4 : 1;
+        waitCourse[s] = head;
+        enqueueWaitlist((int)s + 1, head, (int)(s & 3));
+    }
+    enqueueT.end();
+    report("enqueueWaitlist", n, enqueueT);
+
+    BenchTimer dequeueT;
+    dequeueT.begin();
+    for (long s = 0; s < n; s++)
+        dequeueWaitlist(waitCourse[s]);
+    dequeueT.end();
+    if (gWaitlists.size() != 0)
+        printf("  (dequeueWaitlist left %d entries)\n", gWaitlists.size());
+    report("dequeueWaitlist", n, dequeueT);
+
+    // The same intake again through the bulk path (the waitlists are empty now).
+    vector<WaitlistRequest> requests(n);
+    for (long s = 0; s < n; s++)
+    {
+        requests[s].studentID = (int)s + 1;
+        requests[s].courseID = waitCourse[s];
+        requests[s].priority = (int)(s & 3);
+    }
+    BenchTimer batchT;
+    batchT.begin();
+    long queued = enqueueWaitlistBatch(requests);
+    batchT.end();
+    if (queued != n)
+        printf("  (enqueueWaitlistBatch queued %ld of %ld)\n", queued, n);
+    report("enqueueWaitlistBatch", n, batchT);
+
+    // A lottery window of n requests for a few hot chain heads, each with 100
+    // open seats, so most requests lose and join the waitlist.
+    gWaitlists.clear();
+    long hot = max(1L, n / 1000);
+    for (long h = 0; h < hot; h++)
+    {
+        Course *c = searchCourseByID((int)(h * 4 + 1));
+        c->maxCapacity = c->currentEnrolled + 100;
+    }
+    for (long s = 0; s < n; s++)
+        submitLotteryRequest((int)s + 1, (int)(benchRand(seed) % hot) * 4 + 1, (int)(s & 3));
+    LotteryReport lottery;
+    BenchTimer lotteryT;
+    lotteryT.begin();
+    runSeatLottery(42, lottery);
+    lotteryT.end();
+    if (lottery.enrolled + lottery.waitlisted + lottery.refused != n)
+        printf("  (runSeatLottery accounted for %d of %ld)\n",
+               lottery.enrolled + lottery.waitlisted + lottery.refused, n);
+    report("runSeatLottery (per request)", n, lotteryT);
+
+    // Concurrent registration: every chain head gets two more seats and each
+    // student asks for a random head, from all cores at once.
+    for (long h = 1; h <= n; h += 4)
+    {
+        Course *c = searchCourseByID((int)h);
+        c->maxCapacity = c->currentEnrolled + 2;
+    }
+    vector<int> wanted(n);
+    for (long s = 0; s < n; s++)
+        wanted[s] = chainHead(benchRand(seed), n);
+    int threads = max(1, (int)thread::hardware_concurrency());
+    vector<long> accepted(threads, 0);
+    auto registerRange = [&](int t)
+    {
+        for (long s = n * t / threads; s < n * (t + 1) / threads; s++)
+            accepted[t] += registerEnrollment((int)s + 1, wanted[s]) == OP_OK;
+    };
+    beginRegistration();
+    BenchTimer registerT;
+    registerT.begin();
+    vector<thread> pool;
+    for (int t = 1; t < threads; t++)
+        pool.push_back(thread(registerRange, t));
+    registerRange(0);
+    for (thread &t : pool)
+        t.join();
+    registerT.end();
+    long staged = 0;
+    for (long a : accepted)
+        staged += a;
+    if (endRegistration() != staged)
+        printf("  (endRegistration committed a different count than was accepted)\n");
+    for (long h = 1; h <= n; h += 4)
+    {
+        Course *c = searchCourseByID((int)h);
+        if (c->currentEnrolled > c->maxCapacity)
+            printf("  (course %ld overbooked: %d/%d)\n", h, c->currentEnrolled, c->maxCapacity);
+    }
+    report("registerEnrollment (all cores)", n, registerT);
+}
+
+int main(int argc, char **argv)
+{
+    vector<long> sizes;
+    for (int i = 1; i < argc; i++)
+    {
+        long n = atol(argv[i]);
+        if (n >= 8)
+            sizes.push_back(n);
+    }
+    if (sizes.empty())
+        sizes = {1000, 100000, 1000000};
+
+    setMessageSink(NULL); // measure the operations, not their messages
+
+    checkMigratingErase();
+    printf("%-30s %10s %12s %12s\n", "operation", "n", "ns/op", "allocs/op");
+    for (long n : sizes)
+    {
+        runScale(n);
+        fflush(stdout);
+    }
+
+    resetAllData();
+    return 0;
+}
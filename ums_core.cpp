@@ -0,0 +1,1222 @@
+#include "ums_core.h"
+#include <cstdarg>
+#include <climits>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+StudentStore gStudents;
+CourseNode *gCourseRoot = NULL;
+NodePool<CourseNode> gCourseNodes;
+EnrollmentStore gEnrollments;
+
+WaitlistStore gWaitlists;
+LotteryWindow gLottery;
+
+FlatIdMap<Course *> courseTable; // courseID -> Course* owned by the AVL index
+
+static ConsoleSink gConsoleSink;
+// Each thread has its own current sink, so a worker can silence or redirect its
+// messages without touching what the GUI or console thread sees.
+static thread_local MessageSink *tMessageSink = &gConsoleSink;
+
+const char *opResultText(OpResult r)
+{
+    switch (r)
+    {
+    case OP_OK:
+        return "OK";
+    case OP_NO_STUDENT:
+        return "Student not found";
+    case OP_NO_COURSE:
+        return "Course not found";
+    case OP_DUPLICATE:
+        return "Already exists";
+    case OP_NOT_FOUND:
+        return "Record not found";
+    case OP_COURSE_FULL:
+        return "Course is full";
+    case OP_PREREQS_MISSING:
+        return "Prerequisites not met";
+    case OP_WAITLIST_FULL:
+        return "Waitlist full";
+    case OP_WAITLIST_EMPTY:
+        return "Waitlist empty";
+    case OP_LIMIT_REACHED:
+        return "Limit reached";
+    case OP_CYCLE:
+        return "Would create a prerequisite cycle";
+    }
+    return "Unknown result";
+}
+
+void ConsoleSink::write(const char *msg, size_t len)
+{
+    if (!buffered)
+    {
+        cout.write(msg, len);
+        cout.put('\n');
+        return;
+    }
+    pending.append(msg, len);
+    pending.push_back('\n');
+    if (pending.size() >= FLUSH_BYTES)
+        flush();
+}
+
+void ConsoleSink::flush()
+{
+    if (pending.empty())
+        return;
+    cout.write(pending.data(), pending.size());
+    cout.flush();
+    pending.clear();
+}
+
+MessageSink *setMessageSink(MessageSink *sink)
+{
+    MessageSink *previous = tMessageSink;
+    if (previous)
+        previous->flush();
+    tMessageSink = sink;
+    return previous;
+}
+
+MessageSink *messageSink()
+{
+    return tMessageSink;
+}
+
+void flushMessages()
+{
+    if (tMessageSink)
+        tMessageSink->flush();
+}
+
+void coreMessage(const char *fmt, ...)
+{
+    if (!tMessageSink)
+        return;
+    char buf[256];
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    if (len < 0)
+        return;
+    if (len >= (int)sizeof(buf))
+        len = (int)sizeof(buf) - 1;
+    tMessageSink->write(buf, (size_t)len);
+}
+
+bool studentExists(int id)
+{
+    return gStudents.find(id) != NULL;
+}
+
+OpResult addStudent(int id, const string &name, const string &email,
+                    const string &phone, const string &address, const string &password)
+{
+    Student s;
+    s.ID = id;
+    s.Name = name;
+    s.Email = email;
+    s.Phone = phone;
+    s.Address = address;
+    s.Password = password;
+
+    if (!gStudents.insert(s))
+    {
+        coreMessage("Error: A student with ID %d already exists.", id);
+        return OP_DUPLICATE;
+    }
+
+    if (journalActive())
+    {
+        JournalRecord rec(JOP_ADD_STUDENT);
+        rec.i32(id).str(name).str(email).str(phone).str(address).str(password);
+        journalWrite(rec);
+    }
+    return OP_OK;
+}
+
+OpResult deleteStudent(int id)
+{
+    if (!gStudents.erase(id))
+        return OP_NO_STUDENT;
+
+    if (journalActive())
+    {
+        JournalRecord rec(JOP_DELETE_STUDENT);
+        rec.i32(id);
+        journalWrite(rec);
+    }
+    return OP_OK;
+}
+
+Student *searchStudentByID(int id)
+{
+    return gStudents.find(id);
+}
+
+void sortStudentsByID()
+{
+    gStudents.sortByID();
+}
+
+// The course index is an AVL tree. All operations are iterative and record the
+// links they walk through in `path` so they can rebalance bottom-up; an AVL tree
+// of 2^40 nodes is still shallower than MAX_COURSE_DEPTH.
+static const int MAX_COURSE_DEPTH = 64;
+
+static int courseHeight(CourseNode *node)
+{
+    return node ? node->height : 0;
+}
+
+static void updateCourseHeight(CourseNode *node)
+{
+    int hl = courseHeight(node->left);
+    int hr = courseHeight(node->right);
+    node->height = (hl > hr ? hl : hr) + 1;
+}
+
+static CourseNode *rotateCourseLeft(CourseNode *x)
+{
+    CourseNode *y = x->right;
+    x->right = y->left;
+    y->left = x;
+    updateCourseHeight(x);
+    updateCourseHeight(y);
+    return y;
+}
+
+static CourseNode *rotateCourseRight(CourseNode *y)
+{
+    CourseNode *x = y->left;
+    y->left = x->right;
+    x->right = y;
+    updateCourseHeight(y);
+    updateCourseHeight(x);
+    return x;
+}
+
+static CourseNode *rebalanceCourseNode(CourseNode *node)
+{
+    updateCourseHeight(node);
+    int balance = courseHeight(node->left) - courseHeight(node->right);
+    if (balance > 1)
+    {
+        if (courseHeight(node->left->left) < courseHeight(node->left->right))
+            node->left = rotateCourseLeft(node->left);
+        return rotateCourseRight(node);
+    }
+    if (balance < -1)
+    {
+        if (courseHeight(node->right->right) < courseHeight(node->right->left))
+            node->right = rotateCourseRight(node->right);
+        return rotateCourseLeft(node);
+    }
+    return node;
+}
+
+static void rebalanceCoursePath(CourseNode **path[], int depth)
+{
+    for (int i = depth - 1; i >= 0; i--)
+    {
+        *path[i] = rebalanceCourseNode(*path[i]);
+    }
+}
+
+CourseNode *insertCourseHelper(CourseNode *root, const Course &c)
+{
+    CourseNode **path[MAX_COURSE_DEPTH];
+    int depth = 0;
+    CourseNode **link = &root;
+    while (*link != NULL)
+    {
+        CourseNode *node = *link;
+        if (c.courseID == node->data.courseID)
+            return root;
+        path[depth++] = link;
+        link = (c.courseID < node->data.courseID) ? &node->left : &node->right;
+    }
+
+    CourseNode *newNode = gCourseNodes.create();
+    newNode->data = c;
+    newNode->left = NULL;
+    newNode->right = NULL;
+    newNode->height = 1;
+    *link = newNode;
+
+    rebalanceCoursePath(path, depth);
+    return root;
+}
+
+bool courseExists(int cID)
+{
+    return (searchCourseByID(cID) != NULL);
+}
+
+CourseNode *searchCourseHelper(CourseNode *node, int cID)
+{
+    while (node != NULL && node->data.courseID != cID)
+    {
+        node = (cID < node->data.courseID) ? node->left : node->right;
+    }
+    return node;
+}
+
+Course *searchCourseByID(int cID)
+{
+    Course *c = searchCourseHash(cID);
+    if (c)
+        return c;
+
+    CourseNode *found = searchCourseHelper(gCourseRoot, cID);
+    if (found)
+        return &(found->data);
+
+    return NULL;
+}
+
+// Returns NULL if the course exists or one of its prerequisites would close a
+// cycle (another course already requires this one and is required by it).
+CourseNode *insertCourseBST(const Course &c, const int *prereqIDs, int prereqCount)
+{
+    if (courseExists(c.courseID))
+    {
+        return NULL;
+    }
+    for (int i = 0; i < prereqCount; i++)
+    {
+        if (gPrereqs.wouldCreateCycle(c.courseID, prereqIDs[i]))
+        {
+            coreMessage("Error: prerequisite %d would make course %d require itself.", prereqIDs[i], c.courseID);
+            return NULL;
+        }
+    }
+
+    gCourseRoot = insertCourseHelper(gCourseRoot, c);
+    CourseNode *node = searchCourseHelper(gCourseRoot, c.courseID);
+
+    if (node)
+    {
+        insertCourseHash(&node->data);
+        gPrereqs.setCourse(c.courseID, prereqIDs, prereqCount);
+
+        if (journalActive())
+        {
+            JournalRecord rec(JOP_INSERT_COURSE);
+            rec.i32(c.courseID).str(c.courseName).i32(c.courseCredits).str(c.courseInstructor);
+            rec.i32(c.maxCapacity).i32(c.currentEnrolled).i32(prereqCount);
+            for (int i = 0; i < prereqCount; i++)
+                rec.i32(prereqIDs[i]);
+            journalWrite(rec);
+        }
+    }
+
+    return node;
+}
+
+CourseNode *findMinCourseNode(CourseNode *node)
+{
+    while (node && node->left)
+    {
+        node = node->left;
+    }
+    return node;
+}
+
+// Unlinks and frees the node for cID. A node with two children is replaced by
+// relinking its in-order successor into its place rather than copying the
+// successor's data, so every other CourseNode (and the Course* held by the hash
+// table) keeps its address.
+CourseNode *dropCourseHelper(CourseNode *root, int cID)
+{
+    CourseNode **path[MAX_COURSE_DEPTH];
+    int depth = 0;
+    CourseNode **link = &root;
+    while (*link != NULL && (*link)->data.courseID != cID)
+    {
+        path[depth++] = link;
+        link = (cID < (*link)->data.courseID) ? &(*link)->left : &(*link)->right;
+    }
+    CourseNode *node = *link;
+    if (node == NULL)
+        return root;
+
+    if (node->left == NULL || node->right == NULL)
+    {
+        *link = node->left ? node->left : node->right;
+        gCourseNodes.destroy(node);
+        rebalanceCoursePath(path, depth);
+        return root;
+    }
+
+    int nodeDepth = depth;
+    path[depth++] = link;
+    CourseNode **succLink = &node->right;
+    while ((*succLink)->left != NULL)
+    {
+        path[depth++] = succLink;
+        succLink = &(*succLink)->left;
+    }
+    CourseNode *succ = *succLink;
+    *succLink = succ->right;
+
+    succ->left = node->left;
+    succ->right = node->right;
+    succ->height = node->height;
+    *link = succ;
+    if (depth > nodeDepth + 1)
+        path[nodeDepth + 1] = &succ->right; // was &node->right
+    gCourseNodes.destroy(node);
+
+    rebalanceCoursePath(path, depth);
+    return root;
+}
+
+void dropCourse(int cID)
+{
+    if (!deleteCourseHash(cID)) // unhook the Course* before its node is freed
+        return;
+    gCourseRoot = dropCourseHelper(gCourseRoot, cID);
+    gPrereqs.removeCourse(cID);
+    gWaitlists.eraseCourse(cID);
+
+    if (journalActive())
+    {
+        JournalRecord rec(JOP_DROP_COURSE);
+        rec.i32(cID);
+        journalWrite(rec);
+    }
+}
+
+// Changes the seat limit and fills any seats it opens from the waitlist.
+OpResult setCourseCapacity(int cID, int maxCapacity)
+{
+    Course *c = searchCourseByID(cID);
+    if (!c)
+    {
+        coreMessage("Course doesn't exist.");
+        return OP_NO_COURSE;
+    }
+
+    c->maxCapacity = max(0, maxCapacity);
+
+    if (journalActive())
+    {
+        JournalRecord rec(JOP_SET_CAPACITY);
+        rec.i32(cID).i32(c->maxCapacity);
+        journalWrite(rec);
+    }
+
+    coreMessage("Course %d capacity set to %d.", cID, c->maxCapacity);
+    promoteWaitlist(cID);
+    return OP_OK;
+}
+
+// Bulk teardown of every dataset. Course nodes are destructed in place and the
+// pool is reset in one step, keeping its slabs for the next load.
+void resetAllData()
+{
+    vector<CourseNode *> stack;
+    if (gCourseRoot)
+        stack.push_back(gCourseRoot);
+    while (!stack.empty())
+    {
+        CourseNode *node = stack.back();
+        stack.pop_back();
+        if (node->left)
+            stack.push_back(node->left);
+        if (node->right)
+            stack.push_back(node->right);
+        node->~CourseNode();
+    }
+    gCourseRoot = NULL;
+    gCourseNodes.reset();
+    initCourseHashTable();
+
+    gStudents.clear();
+    gEnrollments.clear();
+    gPrereqs.clear();
+    gCourseIndex.clear();
+    gWaitlists.clear();
+    gLottery.clear();
+
+    if (journalActive())
+    {
+        JournalRecord rec(JOP_RESET_ALL);
+        journalWrite(rec);
+    }
+}
+
+// Records the enrollment once every check has passed; false if it already exists.
+static bool commitEnrollment(int studentID, Course *c)
+{
+    if (!gEnrollments.insert(studentID, c->courseID))
+        return false;
+
+    c->currentEnrolled++;
+
+    if (journalActive())
+    {
+        JournalRecord rec(JOP_ADD_ENROLLMENT);
+        rec.i32(studentID).i32(c->courseID);
+        journalWrite(rec);
+    }
+    return true;
+}
+
+OpResult addEnrollment(int studentID, int courseID)
+{
+    if (!searchStudentByID(studentID))
+    {
+        coreMessage("Error: Student %d doesn't exist.", studentID);
+        return OP_NO_STUDENT;
+    }
+    Course *coursePtr = searchCourseByID(courseID);
+    if (!coursePtr)
+    {
+        coreMessage("Error: Course %d doesn't exist.", courseID);
+        return OP_NO_COURSE;
+    }
+    if (!meetsPrerequisites(studentID, *coursePtr))
+    {
+        coreMessage("Student %d does not meet prerequisites for course %d.", studentID, courseID);
+        return OP_PREREQS_MISSING;
+    }
+
+    if (coursePtr->maxCapacity > 0 && coursePtr->currentEnrolled >= coursePtr->maxCapacity)
+    {
+        coreMessage("Course %d is full (%d/%d). Add student %d to the waitlist instead.",
+                    courseID, coursePtr->currentEnrolled, coursePtr->maxCapacity, studentID);
+        return OP_COURSE_FULL;
+    }
+
+    if (!commitEnrollment(studentID, coursePtr))
+    {
+        coreMessage("Error: Student %d already enrolled in %d.", studentID, courseID);
+        return OP_DUPLICATE;
+    }
+
+    coreMessage("Enrollment added (student %d in course %d).", studentID, courseID);
+    return OP_OK;
+}
+
+OpResult removeEnrollment(int studentID, int courseID)
+{
+    if (!gEnrollments.erase(studentID, courseID))
+    {
+        coreMessage("Enrollment not found.");
+        return OP_NOT_FOUND;
+    }
+
+    Course *c = searchCourseByID(courseID);
+    if (c && c->currentEnrolled > 0)
+        c->currentEnrolled--;
+
+    if (journalActive())
+    {
+        JournalRecord rec(JOP_REMOVE_ENROLLMENT);
+        rec.i32(studentID).i32(courseID);
+        journalWrite(rec);
+    }
+
+    coreMessage("Student %d unenrolled from course %d.", studentID, courseID);
+    if (c)
+        promoteWaitlist(courseID);
+    return OP_OK;
+}
+
+bool isStudentEnrolledInCourse(int studentID, int courseID)
+{
+    return gEnrollments.contains(studentID, courseID);
+}
+
+// Appends prereqID to the course's list and updates the closure of the course
+// and of everything that depends on it. Edges that would close a cycle are
+// rejected with OP_CYCLE.
+OpResult addPrerequisite(int courseID, int prereqID)
+{
+    if (!courseExists(courseID))
+    {
+        coreMessage("Error: Course %d doesn't exist.", courseID);
+        return OP_NO_COURSE;
+    }
+    if (courseID == prereqID)
+    {
+        coreMessage("Course cannot be its own prerequisite.");
+        return OP_CYCLE;
+    }
+    if (!courseExists(prereqID))
+    {
+        coreMessage("Prereq course %d must exist first.", prereqID);
+        return OP_NO_COURSE;
+    }
+    if (gPrereqs.wouldCreateCycle(courseID, prereqID))
+    {
+        coreMessage("Prerequisite %d already requires course %d; adding it would create a cycle.", prereqID, courseID);
+        return OP_CYCLE;
+    }
+    if (gPrereqs.hasPrereq(courseID, prereqID))
+    {
+        coreMessage("Prerequisite %d already added to course %d.", prereqID, courseID);
+        return OP_DUPLICATE;
+    }
+
+    gPrereqs.addPrereq(courseID, prereqID);
+
+    if (journalActive())
+    {
+        JournalRecord rec(JOP_ADD_PREREQ);
+        rec.i32(courseID).i32(prereqID);
+        journalWrite(rec);
+    }
+
+    coreMessage("Prerequisite %d added to course %d.", prereqID, courseID);
+    return OP_OK;
+}
+
+bool checkPrerequisites(int studentID, const Course &course, bool verbose)
+{
+    int missing;
+    if (!gPrereqs.satisfied(studentID, course, &missing))
+    {
+        if (verbose)
+            coreMessage("Missing prerequisite: %d", missing);
+        return false;
+    }
+
+    if (verbose)
+        coreMessage("All prerequisites met. Registration allowed!");
+    return true;
+}
+
+bool meetsPrerequisites(int studentID, const Course &course)
+{
+    return checkPrerequisites(studentID, course, false);
+}
+
+OpResult validatePrerequisites(int courseID, int studentID)
+{
+    Student *s = searchStudentByID(studentID);
+    if (!s)
+    {
+        coreMessage("Error: Student %d doesn't exist.", studentID);
+        return OP_NO_STUDENT;
+    }
+
+    Course *c = searchCourseByID(courseID);
+    if (!c)
+    {
+        coreMessage("Error: Course %d doesn't exist.", courseID);
+        return OP_NO_COURSE;
+    }
+
+    coreMessage("Checking prerequisites for course %d, student %d...", courseID, studentID);
+
+    return checkPrerequisites(studentID, *c, true) ? OP_OK : OP_PREREQS_MISSING;
+}
+
+int parallelRangeCount(int count, int minPerRange)
+{
+    int threads = (int)thread::hardware_concurrency();
+    if (threads < 1)
+        threads = 1;
+    if (minPerRange < 1)
+        minPerRange = 1;
+    return max(1, min(threads, count / minPerRange));
+}
+
+void parallelRanges(int count, int minPerRange, const function<void(int range, int from, int to)> &work)
+{
+    int ranges = parallelRangeCount(count, minPerRange);
+    auto run = [&](int r)
+    {
+        work(r, (int)((long long)count * r / ranges), (int)((long long)count * (r + 1) / ranges));
+    };
+
+    vector<thread> pool;
+    for (int r = 1; r < ranges; r++)
+        pool.push_back(thread(run, r));
+    run(0);
+    for (thread &t : pool)
+        t.join();
+}
+
+// Below this many students per thread, spawning costs more than it saves.
+static const int ELIGIBILITY_MIN_CHUNK = 1 << 15;
+
+OpResult findEligibleStudents(int courseID, long *count,
+                              const function<void(const int *ids, int n)> &onEligible)
+{
+    *count = 0;
+    Course *c = searchCourseByID(courseID);
+    if (!c)
+    {
+        coreMessage("Error: Course %d doesn't exist.", courseID);
+        return OP_NO_COURSE;
+    }
+
+    // The closure and the student/enrollment stores are only read below, so
+    // the ranges can share them without locking.
+    const CourseSet *need = gPrereqs.closureOf(courseID);
+    const Student *records = gStudents.records.data();
+    int students = gStudents.size();
+
+    int ranges = parallelRangeCount(students, ELIGIBILITY_MIN_CHUNK);
+    vector<vector<int>> parts(ranges);
+    vector<long> counts(ranges, 0);
+    bool keepIDs = (bool)onEligible;
+    auto work = [&](int r, int from, int to)
+    {
+        long n = 0;
+        for (int i = from; i < to; i++)
+        {
+            bool ok = need->empty();
+            if (!ok)
+            {
+                const CourseSet *have = gEnrollments.takenBy(records[i].ID);
+                ok = have && have->containsAll(*need);
+            }
+            if (ok)
+            {
+                n++;
+                if (keepIDs)
+                    parts[r].push_back(records[i].ID);
+            }
+        }
+        counts[r] = n;
+    };
+    parallelRanges(students, ELIGIBILITY_MIN_CHUNK, work);
+
+    for (int i = 0; i < ranges; i++)
+    {
+        *count += counts[i];
+        if (keepIDs && !parts[i].empty())
+            onEligible(parts[i].data(), (int)parts[i].size());
+    }
+
+    coreMessage("%ld of %d students are eligible for course %d.", *count, students, courseID);
+    return OP_OK;
+}
+
+OpResult planDegreePath(int studentID, int targetID, int creditCap, DegreePlan &plan)
+{
+    if (!searchStudentByID(studentID))
+    {
+        coreMessage("Error: Student %d doesn't exist.", studentID);
+        plan.result = OP_NO_STUDENT;
+        return plan.result;
+    }
+    if (!courseExists(targetID))
+    {
+        coreMessage("Error: Course %d doesn't exist.", targetID);
+        plan.result = OP_NO_COURSE;
+        return plan.result;
+    }
+
+    gPrereqs.planSemesters(studentID, targetID, creditCap, plan);
+    if (plan.result == OP_NOT_FOUND)
+        coreMessage("Course %d requires course %d, which is no longer offered.", targetID, plan.unavailable);
+    else if (plan.result != OP_OK)
+        coreMessage("Error: %s.", opResultText(plan.result));
+    else if (plan.courseCount == 0)
+        coreMessage("Student %d has already taken course %d.", studentID, targetID);
+    else
+        coreMessage("Student %d needs %d courses (%d credits) over %d semesters to reach course %d.",
+                    studentID, plan.courseCount, plan.credits, (int)plan.semesters.size(), targetID);
+    return plan.result;
+}
+
+// Plans cost microseconds to a few milliseconds each, so small cohorts are
+// still worth splitting.
+static const int PLANNER_MIN_CHUNK = 64;
+
+OpResult planDegreePathCohort(const vector<int> &studentIDs, int targetID, int creditCap, vector<DegreePlan> &plans)
+{
+    int count = (int)studentIDs.size();
+    plans.assign(count, DegreePlan());
+    if (!courseExists(targetID))
+    {
+        coreMessage("Error: Course %d doesn't exist.", targetID);
+        return OP_NO_COURSE;
+    }
+
+    auto work = [&](int, int from, int to)
+    {
+        for (int i = from; i < to; i++)
+        {
+            if (studentExists(studentIDs[i]))
+                gPrereqs.planSemesters(studentIDs[i], targetID, creditCap, plans[i]);
+            else
+            {
+                plans[i].studentID = studentIDs[i];
+                plans[i].result = OP_NO_STUDENT;
+            }
+        }
+    };
+    parallelRanges(count, PLANNER_MIN_CHUNK, work);
+
+    int planned = 0;
+    for (const DegreePlan &p : plans)
+        planned += p.result == OP_OK;
+    coreMessage("Planned course %d for %d of %d students.", targetID, planned, count);
+    return OP_OK;
+}
+
+// Shared by the single and bulk intake paths; validates, queues and journals
+// one request without printing anything.
+static void admitWaitlistRequest(WaitlistRequest &req)
+{
+    req.position = 0;
+    if (!studentExists(req.studentID))
+    {
+        req.result = OP_NO_STUDENT;
+        return;
+    }
+    if (!courseExists(req.courseID))
+    {
+        req.result = OP_NO_COURSE;
+        return;
+    }
+    req.priority = max(0, min(WAITLIST_LEVELS - 1, req.priority));
+    req.position = gWaitlists.insert(req.studentID, req.courseID, req.priority);
+    if (req.position == 0)
+    {
+        req.result = OP_DUPLICATE;
+        return;
+    }
+
+    if (journalActive())
+    {
+        JournalRecord rec(JOP_ENQUEUE_WAITLIST);
+        rec.i32(req.studentID).i32(req.courseID).i32(req.priority);
+        journalWrite(rec);
+    }
+    req.result = OP_OK;
+}
+
+OpResult enqueueWaitlist(int studentID, int courseID, int priority)
+{
+    WaitlistRequest req;
+    req.studentID = studentID;
+    req.courseID = courseID;
+    req.priority = priority;
+    admitWaitlistRequest(req);
+
+    if (req.result == OP_NO_STUDENT)
+        coreMessage("Student doesn't exist.");
+    else if (req.result == OP_NO_COURSE)
+        coreMessage("Course doesn't exist.");
+    else if (req.result == OP_DUPLICATE)
+        coreMessage("Already waitlisted.");
+    else
+        coreMessage("Student %d waitlisted for course %d (position %d).",
+                    studentID, courseID, req.position);
+    return req.result;
+}
+
+int enqueueWaitlistBatch(vector<WaitlistRequest> &requests)
+{
+    gWaitlists.reserve((int)requests.size());
+    JournalBatch batch;
+    int queued = 0;
+    for (WaitlistRequest &req : requests)
+    {
+        admitWaitlistRequest(req);
+        queued += req.result == OP_OK;
+    }
+    coreMessage("Waitlisted %d of %d requests.", queued, (int)requests.size());
+    return queued;
+}
+
+static void takeWaitlistEntry(int studentID, int courseID)
+{
+    gWaitlists.erase(studentID, courseID);
+    if (journalActive())
+    {
+        JournalRecord rec(JOP_DEQUEUE_WAITLIST);
+        rec.i32(studentID).i32(courseID);
+        journalWrite(rec);
+    }
+}
+
+// Promotes the entry the course serves next (highest priority, then oldest)
+// if the course has room and the student qualifies. Each course's waitlist is
+// independent, so a full course never holds up another. Entries whose student
+// has been deleted are discarded on the way.
+OpResult dequeueWaitlist(int courseID)
+{
+    Course *c = searchCourseByID(courseID);
+    if (!c)
+    {
+        coreMessage("Course doesn't exist.");
+        return OP_NO_COURSE;
+    }
+
+    const WaitlistItem *w;
+    while ((w = gWaitlists.front(courseID)) && !studentExists(w->studentID))
+    {
+        coreMessage("Removed waitlist entry for deleted student %d.", w->studentID);
+        takeWaitlistEntry(w->studentID, courseID);
+    }
+    if (!w)
+    {
+        return OP_WAITLIST_EMPTY;
+    }
+
+    if (c->maxCapacity > 0 && c->currentEnrolled >= c->maxCapacity)
+    {
+        coreMessage("Course %d is still full (%d/%d). Waitlist remains unchanged.",
+                    courseID, c->currentEnrolled, c->maxCapacity);
+        return OP_COURSE_FULL;
+    }
+
+    int studentID = w->studentID;
+    if (!meetsPrerequisites(studentID, *c))
+    {
+        coreMessage("Student %d does not meet prerequisites for course %d. Waitlist remains unchanged.",
+                    studentID, courseID);
+        return OP_PREREQS_MISSING;
+    }
+
+    takeWaitlistEntry(studentID, courseID);
+    coreMessage("Enrolling student %d from waitlist in course %d.", studentID, courseID);
+    return addEnrollment(studentID, courseID);
+}
+
+// Walks the course's queue once in service order, enrolling qualified students
+// until the seats run out. A student missing prerequisites keeps their place
+// but does not hold up the ones behind them; entries for deleted or
+// already-enrolled students are dropped. All the journal records of one pass
+// share a single group commit.
+int promoteWaitlist(int courseID)
+{
+    Course *c = searchCourseByID(courseID);
+    if (!c || gWaitlists.countFor(courseID) == 0)
+        return 0;
+    long seats = c->maxCapacity > 0 ? (long)c->maxCapacity - c->currentEnrolled : LONG_MAX;
+    if (seats <= 0)
+        return 0;
+
+    vector<int> promoted, stale;
+    int passedOver = 0;
+    auto pick = [&](const WaitlistItem &w)
+    {
+        if (!studentExists(w.studentID) || gEnrollments.contains(w.studentID, courseID))
+            stale.push_back(w.studentID);
+        else if (!meetsPrerequisites(w.studentID, *c))
+            passedOver++;
+        else
+            promoted.push_back(w.studentID);
+        return (long)promoted.size() < seats;
+    };
+    gWaitlists.scanIn(courseID, pick);
+
+    JournalBatch batch;
+    for (int studentID : stale)
+        takeWaitlistEntry(studentID, courseID);
+    for (int studentID : promoted)
+    {
+        takeWaitlistEntry(studentID, courseID);
+        commitEnrollment(studentID, c);
+    }
+
+    if (!promoted.empty() || passedOver > 0)
+        coreMessage("Promoted %d waitlisted student(s) into course %d; %d passed over for prerequisites.",
+                    (int)promoted.size(), courseID, passedOver);
+    return (int)promoted.size();
+}
+
+OpResult submitLotteryRequest(int studentID, int courseID, int standing)
+{
+    if (!studentExists(studentID))
+    {
+        coreMessage("Student doesn't exist.");
+        return OP_NO_STUDENT;
+    }
+    if (!courseExists(courseID))
+    {
+        coreMessage("Course doesn't exist.");
+        return OP_NO_COURSE;
+    }
+    if (!gLottery.slotByPair.insert(EnrollmentStore::pairKey(studentID, courseID), gLottery.size()))
+    {
+        coreMessage("Student %d already entered the lottery for course %d.", studentID, courseID);
+        return OP_DUPLICATE;
+    }
+
+    LotteryEntry e;
+    e.studentID = studentID;
+    e.courseID = courseID;
+    e.standing = max(0, min(WAITLIST_LEVELS - 1, standing));
+    gLottery.entries.push_back(e);
+    return OP_OK;
+}
+
+// Exponential draw key (Efraimidis-Spirakis): sorting by it is a weighted
+// shuffle. Hashing (seed, course, student) rather than drawing from a stream
+// keeps every ticket independent of submission order and thread split.
+static double lotteryTicket(unsigned long long seed, const LotteryEntry &e)
+{
+    unsigned long long pair = (unsigned long long)EnrollmentStore::pairKey(e.studentID, e.courseID);
+    unsigned long long h = mixHash64(seed ^ mixHash64(pair));
+    double u = ((h >> 11) + 1) * (1.0 / 9007199254740992.0); // (0, 1]
+    return -log(u) / (e.standing + 1);
+}
+
+static bool drawsBefore(const LotteryEntry &a, const LotteryEntry &b)
+{
+    bool aIn = a.result == OP_OK, bIn = b.result == OP_OK;
+    if (aIn != bIn)
+        return aIn;
+    if (a.ticket != b.ticket)
+        return a.ticket < b.ticket;
+    return a.studentID < b.studentID;
+}
+
+// Courses per thread below which the draw stays on fewer threads.
+static const int LOTTERY_MIN_COURSES = 16;
+
+int runSeatLottery(unsigned long long seed, LotteryReport &report)
+{
+    chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+    report = LotteryReport();
+    report.entries.swap(gLottery.entries);
+    gLottery.clear();
+    vector<LotteryEntry> &entries = report.entries;
+
+    auto byCourse = [](const LotteryEntry &a, const LotteryEntry &b)
+    {
+        return a.courseID != b.courseID ? a.courseID < b.courseID : a.studentID < b.studentID;
+    };
+    sort(entries.begin(), entries.end(), byCourse);
+    vector<int> groupStart;
+    for (int i = 0; i < (int)entries.size(); i++)
+    {
+        if (i == 0 || entries[i].courseID != entries[i - 1].courseID)
+            groupStart.push_back(i);
+    }
+    int groups = (int)groupStart.size();
+    groupStart.push_back((int)entries.size());
+
+    // Each course is decided from read-only state, so courses draw in
+    // parallel; the outcome depends only on the seed and the window.
+    auto draw = [&](int, int from, int to)
+    {
+        for (int g = from; g < to; g++)
+        {
+            LotteryEntry *first = entries.data() + groupStart[g];
+            LotteryEntry *last = entries.data() + groupStart[g + 1];
+            const Course *c = searchCourseByID(first->courseID);
+            for (LotteryEntry *e = first; e != last; e++)
+            {
+                if (!c)
+                    e->result = OP_NO_COURSE;
+                else if (!studentExists(e->studentID))
+                    e->result = OP_NO_STUDENT;
+                else if (gEnrollments.contains(e->studentID, e->courseID))
+                    e->result = OP_DUPLICATE;
+                else if (!meetsPrerequisites(e->studentID, *c))
+                    e->result = OP_PREREQS_MISSING;
+                else
+                    e->result = OP_OK;
+                e->ticket = lotteryTicket(seed, *e);
+            }
+            sort(first, last, drawsBefore);
+
+            long seats = !c ? 0 : c->maxCapacity > 0 ? (long)c->maxCapacity - c->currentEnrolled : LONG_MAX;
+            for (LotteryEntry *e = first; e != last && e->result == OP_OK; e++)
+            {
+                if (e - first >= seats)
+                    e->result = OP_COURSE_FULL;
+            }
+        }
+    };
+    parallelRanges(groups, LOTTERY_MIN_COURSES, draw);
+
+    JournalBatch batch;
+    Course *c = NULL;
+    for (LotteryEntry &e : entries)
+    {
+        if (!c || c->courseID != e.courseID)
+            c = searchCourseByID(e.courseID);
+        if (e.result == OP_OK)
+        {
+            if (gWaitlists.contains(e.studentID, e.courseID))
+                takeWaitlistEntry(e.studentID, e.courseID);
+            commitEnrollment(e.studentID, c);
+            report.enrolled++;
+        }
+        else if (e.result == OP_COURSE_FULL)
+        {
+            WaitlistRequest req;
+            req.studentID = e.studentID;
+            req.courseID = e.courseID;
+            req.priority = e.standing;
+            admitWaitlistRequest(req); // a student already waitlisted keeps that place
+            report.waitlisted++;
+        }
+        else
+        {
+            report.refused++;
+        }
+    }
+    report.courses = groups;
+    report.seconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    coreMessage("Lottery for %d courses: %d enrolled, %d waitlisted, %d refused (%.3f s).",
+                groups, report.enrolled, report.waitlisted, report.refused, report.seconds);
+    return report.enrolled;
+}
+
+// One per course for the length of a registration session, each on its own
+// cache line so threads working on different courses share nothing.
+class alignas(64) RegistrationSlot
+{
+public:
+    mutex lock;
+    Course *course = NULL;
+    int reserved = 0;      // seats taken this session, on top of currentEnrolled
+    FlatIdMap<int> staged; // studentID -> 1
+    vector<int> students;  // staged, in acceptance order
+};
+
+static vector<RegistrationSlot> gRegSlots;
+static FlatIdMap<int> gRegSlotOf; // courseID -> index into gRegSlots
+static bool gRegOpen = false;
+
+bool beginRegistration()
+{
+    if (gRegOpen)
+        return false;
+
+    vector<Course *> courses;
+    vector<CourseNode *> stack;
+    CourseNode *node = gCourseRoot;
+    while (node || !stack.empty())
+    {
+        while (node)
+        {
+            stack.push_back(node);
+            node = node->left;
+        }
+        node = stack.back();
+        stack.pop_back();
+        courses.push_back(&node->data);
+        node = node->right;
+    }
+
+    vector<RegistrationSlot> slots(courses.size());
+    gRegSlots.swap(slots);
+    gRegSlotOf.clear();
+    gRegSlotOf.reserve((int)courses.size());
+    for (int i = 0; i < (int)courses.size(); i++)
+    {
+        gRegSlots[i].course = courses[i];
+        gRegSlotOf.insert(courses[i]->courseID, i);
+    }
+    gRegOpen = true;
+    coreMessage("Registration open for %d courses.", (int)courses.size());
+    return true;
+}
+
+// Everything before the lock only reads state that is frozen for the session;
+// the lock covers just the seat check and the staging of this one course.
+OpResult registerEnrollment(int studentID, int courseID)
+{
+    const int *slotIdx = gRegSlotOf.find(courseID);
+    if (!gRegOpen || !slotIdx)
+        return OP_NO_COURSE;
+    if (!studentExists(studentID))
+        return OP_NO_STUDENT;
+
+    RegistrationSlot &slot = gRegSlots[*slotIdx];
+    const Course *c = slot.course;
+    if (gEnrollments.contains(studentID, courseID))
+        return OP_DUPLICATE;
+    if (!meetsPrerequisites(studentID, *c))
+        return OP_PREREQS_MISSING;
+
+    lock_guard<mutex> hold(slot.lock);
+    if (c->maxCapacity > 0 && c->currentEnrolled + slot.reserved >= c->maxCapacity)
+        return OP_COURSE_FULL;
+    if (!slot.staged.insert(studentID, 1))
+        return OP_DUPLICATE;
+    slot.reserved++;
+    slot.students.push_back(studentID);
+    return OP_OK;
+}
+
+int endRegistration()
+{
+    if (!gRegOpen)
+        return 0;
+
+    JournalBatch batch;
+    int committed = 0;
+    for (RegistrationSlot &slot : gRegSlots)
+    {
+        for (int studentID : slot.students)
+            committed += commitEnrollment(studentID, slot.course);
+    }
+
+    vector<RegistrationSlot>().swap(gRegSlots);
+    gRegSlotOf.clear();
+    gRegOpen = false;
+    coreMessage("Registration closed: %d enrollments committed.", committed);
+    return committed;
+}
+
+void initCourseHashTable()
+{
+    courseTable.clear();
+}
+
+void insertCourseHash(Course *cPtr)
+{
+    if (!cPtr)
+        return;
+
+    Course **slot = courseTable.find(cPtr->courseID);
+    if (slot)
+        *slot = cPtr;
+    else
+        courseTable.insert(cPtr->courseID, cPtr);
+}
+
+int rebuildHashFromBST(CourseNode *node)
+{
+    int count = 0;
+    vector<CourseNode *> stack;
+    while (node || !stack.empty())
+    {
+        while (node)
+        {
+            stack.push_back(node);
+            node = node->left;
+        }
+        node = stack.back();
+        stack.pop_back();
+
+        insertCourseHash(&node->data);
+        count++;
+
+        node = node->right;
+    }
+    return count;
+}
+
+Course *searchCourseHash(int cID)
+{
+    Course **slot = courseTable.find(cID);
+    return slot ? *slot : NULL;
+}
+
+bool deleteCourseHash(int cID)
+{
+    return courseTable.erase(cID);
+}
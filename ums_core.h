@@ -0,0 +1,1585 @@
+// Headless core of the University Management System: the data structures and
+// operations shared by the raylib GUI, the console menus and the benchmarks.
+// Nothing in here depends on raylib.
+#ifndef UMS_CORE_H
+#define UMS_CORE_H
+
+#include <cstring>
+#include <cstdio>
+#include <cctype>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <iostream>
+#include <cmath>
+#include <new>
+#include <cstdint>
+#include <functional>
+#include <atomic>
+using namespace std;
+
+class Student
+{
+public:
+    int ID;
+    string Name;
+    string Email;
+    string Phone;
+    string Address;
+    string Password;
+};
+
+static inline unsigned long long mixHash64(unsigned long long x) // splitmix64 finalizer, spreads sequential IDs
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+// Open-addressing map from an integer key to V (linear probing, backward-shift delete).
+// Growing does not rehash everything at once: the full table is parked as `old`
+// and each later insert/erase migrates MIGRATE_STEP of its slots, so no single
+// call pays for the whole resize. Lookups check the new table, then the old one.
+template <typename V>
+class FlatIdMap
+{
+public:
+    static const int MIGRATE_STEP = 64;
+
+    vector<long long> keys;
+    vector<V> vals;
+    vector<unsigned char> used; // 0 empty, 1 occupied
+
+    vector<long long> oldKeys;
+    vector<V> oldVals;
+    vector<unsigned char> oldUsed; // 0 empty, 1 occupied, 2 erased
+    size_t migrateCursor = 0;
+    int oldCount = 0;
+    int count = 0; // live entries in the current table
+
+    int size() const { return count + oldCount; }
+    int capacity() const { return (int)(used.size() + oldUsed.size()); }
+    bool migrating() const { return !oldUsed.empty(); }
+
+    void clear()
+    {
+        keys.clear();
+        vals.clear();
+        used.clear();
+        oldKeys.clear();
+        oldVals.clear();
+        oldUsed.clear();
+        migrateCursor = 0;
+        oldCount = 0;
+        count = 0;
+    }
+
+    void reserve(int n) // bulk loads: one full rehash up front
+    {
+        size_t want = 16;
+        while (want * 7 < (size_t)n * 10)
+            want <<= 1;
+        if (want > used.size())
+        {
+            finishMigration();
+            rehash(want);
+        }
+    }
+
+    V *find(long long key)
+    {
+        if (count > 0)
+        {
+            size_t mask = used.size() - 1;
+            size_t i = mixHash64((unsigned long long)key) & mask;
+            while (used[i])
+            {
+                if (keys[i] == key)
+                    return &vals[i];
+                i = (i + 1) & mask;
+            }
+        }
+        if (oldCount > 0)
+        {
+            size_t mask = oldUsed.size() - 1;
+            size_t i = mixHash64((unsigned long long)key) & mask;
+            while (oldUsed[i])
+            {
+                if (oldUsed[i] == 1 && oldKeys[i] == key)
+                    return &oldVals[i];
+                i = (i + 1) & mask;
+            }
+        }
+        return NULL;
+    }
+
+    const V *find(long long key) const
+    {
+        return const_cast<FlatIdMap *>(this)->find(key);
+    }
+
+    bool insert(long long key, const V &val) // false if the key is already present
+    {
+        migrateStep();
+        if (find(key))
+            return false;
+        if ((size_t)(count + 1) * 10 > used.size() * 7)
+            grow();
+        place(key, val);
+        return true;
+    }
+
+    bool erase(long long key)
+    {
+        migrateStep();
+        if (count > 0 && eraseCurrent(key))
+            return true;
+        if (oldCount > 0)
+        {
+            size_t mask = oldUsed.size() - 1;
+            size_t i = mixHash64((unsigned long long)key) & mask;
+            while (oldUsed[i])
+            {
+                if (oldUsed[i] == 1 && oldKeys[i] == key)
+                {
+                    oldUsed[i] = 2; // tombstone; the old table is never probed for inserts
+                    oldCount--;
+                    return true;
+                }
+                i = (i + 1) & mask;
+            }
+        }
+        return false;
+    }
+
+    void finishMigration()
+    {
+        while (migrating())
+            migrateStep();
+    }
+
+private:
+    void place(long long key, const V &val)
+    {
+        size_t mask = used.size() - 1;
+        size_t i = mixHash64((unsigned long long)key) & mask;
+        while (used[i])
+            i = (i + 1) & mask;
+        used[i] = 1;
+        keys[i] = key;
+        vals[i] = val;
+        count++;
+    }
+
+    bool eraseCurrent(long long key)
+    {
+        size_t mask = used.size() - 1;
+        size_t i = mixHash64((unsigned long long)key) & mask;
+        while (used[i] && keys[i] != key)
+            i = (i + 1) & mask;
+        if (!used[i])
+            return false;
+
+        // shift later members of the probe run back so lookups never hit a hole
+        size_t hole = i;
+        size_t j = i;
+        while (true)
+        {
+            j = (j + 1) & mask;
+            if (!used[j])
+                break;
+            size_t home = mixHash64((unsigned long long)keys[j]) & mask;
+            if (((j - home) & mask) >= ((j - hole) & mask))
+            {
+                keys[hole] = keys[j];
+                vals[hole] = vals[j];
+                hole = j;
+            }
+        }
+        used[hole] = 0;
+        count--;
+        return true;
+    }
+
+    void grow()
+    {
+        finishMigration();
+        size_t newCap = used.empty() ? 16 : used.size() * 2;
+        if (count == 0)
+        {
+            rehash(newCap);
+            return;
+        }
+        oldKeys.swap(keys);
+        oldVals.swap(vals);
+        oldUsed.swap(used);
+        oldCount = count;
+        migrateCursor = 0;
+        keys.assign(newCap, 0);
+        vals.assign(newCap, V());
+        used.assign(newCap, 0);
+        count = 0;
+    }
+
+    void migrateStep()
+    {
+        if (!migrating())
+            return;
+        size_t end = migrateCursor + MIGRATE_STEP;
+        if (end > oldUsed.size())
+            end = oldUsed.size();
+        for (; migrateCursor < end; migrateCursor++)
+        {
+            if (oldUsed[migrateCursor] == 1)
+            {
+                place(oldKeys[migrateCursor], oldVals[migrateCursor]);
+                oldUsed[migrateCursor] = 2; // moved; a tombstone keeps later probe runs intact
+                oldCount--;
+            }
+        }
+        if (migrateCursor == oldUsed.size())
+        {
+            vector<long long>().swap(oldKeys);
+            vector<V>().swap(oldVals);
+            vector<unsigned char>().swap(oldUsed);
+            migrateCursor = 0;
+            oldCount = 0;
+        }
+    }
+
+    void rehash(size_t newCap)
+    {
+        vector<long long> prevKeys;
+        vector<V> prevVals;
+        vector<unsigned char> prevUsed;
+        prevKeys.swap(keys);
+        prevVals.swap(vals);
+        prevUsed.swap(used);
+
+        keys.assign(newCap, 0);
+        vals.assign(newCap, V());
+        used.assign(newCap, 0);
+        count = 0;
+        for (size_t k = 0; k < prevUsed.size(); k++)
+        {
+            if (prevUsed[k])
+                place(prevKeys[k], prevVals[k]);
+        }
+    }
+};
+
+// Dense index for every course ID seen, as a course or as a prerequisite.
+// Indices are never recycled, so bitsets built over them stay valid while
+// courses come and go; only resetAllData() starts the numbering over.
+class CourseIndex
+{
+public:
+    FlatIdMap<int> indexOf;
+    vector<int> courseIdOf;
+
+    int size() const { return (int)courseIdOf.size(); }
+
+    int find(int courseID) const // -1 if never seen
+    {
+        const int *idx = indexOf.find(courseID);
+        return idx ? *idx : -1;
+    }
+
+    int intern(int courseID)
+    {
+        int *idx = indexOf.find(courseID);
+        if (idx)
+            return *idx;
+        int fresh = (int)courseIdOf.size();
+        indexOf.insert(courseID, fresh);
+        courseIdOf.push_back(courseID);
+        return fresh;
+    }
+
+    void clear()
+    {
+        indexOf.clear();
+        courseIdOf.clear();
+    }
+};
+
+extern CourseIndex gCourseIndex;
+
+// A set of dense course indices as sorted (word, bits) pairs: one entry per
+// occupied block of 64 indices, so a student or a closure costs space for
+// what it holds rather than for the whole catalog. Words and bits are kept in
+// separate arrays so the bits can be compared with vector instructions.
+class CourseSet
+{
+public:
+    vector<uint32_t> wordAt;
+    vector<uint64_t> bits;
+
+    bool empty() const { return wordAt.empty(); }
+
+    void clear()
+    {
+        wordAt.clear();
+        bits.clear();
+    }
+
+    bool has(int idx) const
+    {
+        size_t i = lower_bound(wordAt.begin(), wordAt.end(), (uint32_t)idx / 64) - wordAt.begin();
+        return i < wordAt.size() && wordAt[i] == (uint32_t)idx / 64 && (bits[i] >> (idx % 64) & 1);
+    }
+
+    void add(int idx)
+    {
+        uint32_t w = (uint32_t)idx / 64;
+        size_t i = lower_bound(wordAt.begin(), wordAt.end(), w) - wordAt.begin();
+        if (i == wordAt.size() || wordAt[i] != w)
+        {
+            wordAt.insert(wordAt.begin() + i, w);
+            bits.insert(bits.begin() + i, 0);
+        }
+        bits[i] |= 1ULL << (idx % 64);
+    }
+
+    void remove(int idx)
+    {
+        uint32_t w = (uint32_t)idx / 64;
+        size_t i = lower_bound(wordAt.begin(), wordAt.end(), w) - wordAt.begin();
+        if (i == wordAt.size() || wordAt[i] != w)
+            return;
+        bits[i] &= ~(1ULL << (idx % 64));
+        if (bits[i] == 0)
+        {
+            wordAt.erase(wordAt.begin() + i);
+            bits.erase(bits.begin() + i);
+        }
+    }
+
+    bool sameAs(const CourseSet &o) const { return wordAt == o.wordAt && bits == o.bits; }
+
+    // True if every index in `need` is also here; otherwise `missing` (if
+    // given) receives the lowest index that is not.
+    bool containsAll(const CourseSet &need, int *missing = NULL) const;
+};
+
+class PoolStats
+{
+public:
+    int live = 0;              // objects currently in use
+    size_t bytesReserved = 0;  // memory held for records (excluding index tables)
+    double fragmentation = 0;  // share of handed-out slots that are freed holes
+};
+
+// Typed slab allocator. Slots come from large slabs in allocation order, freed
+// slots go on an intrusive free list and are reused first. reset() forgets every
+// slot at once but keeps the slabs, so reloading a dataset does not touch malloc.
+template <typename T>
+class NodePool
+{
+public:
+    static const int SLAB_SIZE = 512;
+
+    ~NodePool() { release(); }
+
+    T *create()
+    {
+        Slot *slot = freeList;
+        if (slot)
+        {
+            freeList = slot->nextFree;
+            holes--;
+        }
+        else
+        {
+            if (cursor == slabEnd)
+                nextSlab(SLAB_SIZE);
+            slot = cursor++;
+        }
+        live++;
+        return new (slot->storage) T();
+    }
+
+    void destroy(T *obj)
+    {
+        if (!obj)
+            return;
+        obj->~T();
+        Slot *slot = reinterpret_cast<Slot *>(obj);
+        slot->nextFree = freeList;
+        freeList = slot;
+        live--;
+        holes++;
+    }
+
+    void reserve(int n) // make room for n more objects without further slab allocations
+    {
+        size_t room = (size_t)(slabEnd - cursor) + holes;
+        for (size_t i = current + 1; i < slabs.size(); i++)
+            room += slabCaps[i];
+        if ((size_t)n > room)
+            addSlab(n - room);
+    }
+
+    // Drops every object without running destructors: the caller must already
+    // have destroyed them (or T must be trivially destructible).
+    void reset()
+    {
+        freeList = NULL;
+        live = 0;
+        holes = 0;
+        current = -1;
+        cursor = slabEnd = NULL;
+    }
+
+    void release()
+    {
+        for (Slot *slab : slabs)
+            ::operator delete(slab);
+        slabs.clear();
+        slabCaps.clear();
+        reset();
+    }
+
+    PoolStats stats() const
+    {
+        PoolStats st;
+        st.live = live;
+        for (int cap : slabCaps)
+            st.bytesReserved += (size_t)cap * sizeof(Slot);
+        st.fragmentation = (live + holes) ? (double)holes / (live + holes) : 0.0;
+        return st;
+    }
+
+private:
+    union Slot
+    {
+        Slot *nextFree;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    vector<Slot *> slabs;
+    vector<int> slabCaps;
+    int current = -1;
+    Slot *cursor = NULL;
+    Slot *slabEnd = NULL;
+    Slot *freeList = NULL;
+    int live = 0;
+    int holes = 0;
+
+    void nextSlab(int cap)
+    {
+        if (current + 1 == (int)slabs.size())
+            addSlab(cap);
+        current++;
+        cursor = slabs[current];
+        slabEnd = cursor + slabCaps[current];
+    }
+
+    void addSlab(size_t cap)
+    {
+        slabs.push_back(static_cast<Slot *>(::operator new(cap * sizeof(Slot))));
+        slabCaps.push_back((int)cap);
+    }
+};
+
+// Students live contiguously in `records`; `slotByID` maps an ID to its index.
+// Deletion moves the last record into the hole, so Student* is only valid until the next insert/delete.
+class StudentStore
+{
+public:
+    vector<Student> records;
+    FlatIdMap<int> slotByID;
+
+    int size() const { return (int)records.size(); }
+
+    void reserve(int n)
+    {
+        records.reserve(n);
+        slotByID.reserve(n);
+    }
+
+    void clear()
+    {
+        records.clear();
+        slotByID.clear();
+    }
+
+    PoolStats stats() const
+    {
+        PoolStats st;
+        st.live = size();
+        st.bytesReserved = records.capacity() * sizeof(Student);
+        return st;
+    }
+
+    Student *find(int id)
+    {
+        int *slot = slotByID.find(id);
+        return slot ? &records[*slot] : NULL;
+    }
+
+    bool insert(const Student &s)
+    {
+        if (!slotByID.insert(s.ID, (int)records.size()))
+            return false;
+        records.push_back(s);
+        return true;
+    }
+
+    bool erase(int id)
+    {
+        int *slot = slotByID.find(id);
+        if (!slot)
+            return false;
+        int idx = *slot;
+        int last = (int)records.size() - 1;
+        if (idx != last)
+        {
+            records[idx] = std::move(records[last]);
+            *slotByID.find(records[idx].ID) = idx;
+        }
+        records.pop_back();
+        slotByID.erase(id);
+        return true;
+    }
+
+    void sortByID()
+    {
+        sort(records.begin(), records.end(),
+             [](const Student &a, const Student &b)
+             { return a.ID < b.ID; });
+        for (int i = 0; i < (int)records.size(); i++)
+        {
+            *slotByID.find(records[i].ID) = i;
+        }
+    }
+};
+
+class Course
+{
+public:
+    int courseID;
+    string courseName;
+    int courseCredits;
+    string courseInstructor;
+
+    int maxCapacity;
+    int currentEnrolled;
+
+    // Prerequisites are not stored here: gPrereqs owns the edges in both
+    // directions (forEachPrereq / forEachDependant), so copying a Course
+    // copies no list.
+    Course()
+    {
+        maxCapacity = 0;
+        currentEnrolled = 0;
+    }
+};
+
+class CourseNode
+{
+public:
+    Course data;
+    CourseNode *left;
+    CourseNode *right;
+    int height; // AVL height, leaf = 1
+};
+
+class Enrollment
+{
+public:
+    int studentID;
+    int courseID;
+};
+
+// One enrollment slot, threaded on three index-linked lists: global insertion
+// order, the student's history and the course's roster (-1 = none).
+class EnrollmentRecord
+{
+public:
+    Enrollment data;
+    int prev, next;
+    int prevByStudent, nextByStudent;
+    int prevByCourse, nextByCourse;
+};
+
+class EnrollmentList
+{
+public:
+    int head = -1;
+    int tail = -1;
+    int count = 0;
+    int taken = -1; // by-student lists: slot in EnrollmentStore::takenSets
+};
+
+// Enrollments indexed by (student, course) pair, by student and by course.
+// Membership is one hash probe; a history or roster walk touches only its k records.
+// Each student also carries a CourseSet of the courses they are enrolled in,
+// over gCourseIndex, which is what prerequisite checks test against.
+class EnrollmentStore
+{
+public:
+    vector<EnrollmentRecord> records;
+    vector<int> freeSlots;
+    int head = -1;
+    int tail = -1;
+    int live = 0;
+
+    FlatIdMap<int> slotByPair;
+    FlatIdMap<EnrollmentList> byStudent;
+    FlatIdMap<EnrollmentList> byCourse;
+    vector<CourseSet> takenSets;
+    vector<int> freeTakenSets;
+
+    static long long pairKey(int studentID, int courseID)
+    {
+        return (long long)(((unsigned long long)(unsigned int)studentID << 32) | (unsigned int)courseID);
+    }
+
+    int size() const { return live; }
+
+    void reserve(int n, int students = 0, int courses = 0)
+    {
+        records.reserve(n);
+        slotByPair.reserve(n);
+        byStudent.reserve(students);
+        byCourse.reserve(courses);
+    }
+
+    void clear()
+    {
+        records.clear();
+        freeSlots.clear();
+        head = tail = -1;
+        live = 0;
+        slotByPair.clear();
+        byStudent.clear();
+        byCourse.clear();
+        takenSets.clear();
+        freeTakenSets.clear();
+    }
+
+    PoolStats stats() const
+    {
+        PoolStats st;
+        st.live = live;
+        st.bytesReserved = records.capacity() * sizeof(EnrollmentRecord);
+        st.fragmentation = records.empty() ? 0.0 : (double)freeSlots.size() / records.size();
+        return st;
+    }
+
+    bool contains(int studentID, int courseID) const
+    {
+        return slotByPair.find(pairKey(studentID, courseID)) != NULL;
+    }
+
+    bool insert(int studentID, int courseID)
+    {
+        int idx;
+        if (!freeSlots.empty())
+        {
+            idx = freeSlots.back();
+        }
+        else
+        {
+            idx = (int)records.size();
+        }
+        if (!slotByPair.insert(pairKey(studentID, courseID), idx))
+            return false;
+        if (idx == (int)records.size())
+            records.push_back(EnrollmentRecord());
+        else
+            freeSlots.pop_back();
+
+        EnrollmentRecord &r = records[idx];
+        r.data.studentID = studentID;
+        r.data.courseID = courseID;
+
+        r.prev = tail;
+        r.next = -1;
+        if (tail >= 0)
+            records[tail].next = idx;
+        else
+            head = idx;
+        tail = idx;
+
+        EnrollmentList &sl = listFor(byStudent, studentID);
+        r.prevByStudent = sl.tail;
+        r.nextByStudent = -1;
+        if (sl.tail >= 0)
+            records[sl.tail].nextByStudent = idx;
+        else
+            sl.head = idx;
+        sl.tail = idx;
+        sl.count++;
+        if (sl.taken < 0)
+        {
+            if (!freeTakenSets.empty())
+            {
+                sl.taken = freeTakenSets.back();
+                freeTakenSets.pop_back();
+            }
+            else
+            {
+                sl.taken = (int)takenSets.size();
+                takenSets.push_back(CourseSet());
+            }
+        }
+        takenSets[sl.taken].add(gCourseIndex.intern(courseID));
+
+        EnrollmentList &cl = listFor(byCourse, courseID);
+        r.prevByCourse = cl.tail;
+        r.nextByCourse = -1;
+        if (cl.tail >= 0)
+            records[cl.tail].nextByCourse = idx;
+        else
+            cl.head = idx;
+        cl.tail = idx;
+        cl.count++;
+
+        live++;
+        return true;
+    }
+
+    bool erase(int studentID, int courseID)
+    {
+        int *slot = slotByPair.find(pairKey(studentID, courseID));
+        if (!slot)
+            return false;
+        int idx = *slot;
+        slotByPair.erase(pairKey(studentID, courseID));
+        EnrollmentRecord &r = records[idx];
+
+        if (r.prev >= 0)
+            records[r.prev].next = r.next;
+        else
+            head = r.next;
+        if (r.next >= 0)
+            records[r.next].prev = r.prev;
+        else
+            tail = r.prev;
+
+        EnrollmentList *sl = byStudent.find(studentID);
+        if (r.prevByStudent >= 0)
+            records[r.prevByStudent].nextByStudent = r.nextByStudent;
+        else
+            sl->head = r.nextByStudent;
+        if (r.nextByStudent >= 0)
+            records[r.nextByStudent].prevByStudent = r.prevByStudent;
+        else
+            sl->tail = r.prevByStudent;
+        takenSets[sl->taken].remove(gCourseIndex.find(courseID));
+        if (--sl->count == 0)
+        {
+            freeTakenSets.push_back(sl->taken);
+            byStudent.erase(studentID);
+        }
+
+        EnrollmentList *cl = byCourse.find(courseID);
+        if (r.prevByCourse >= 0)
+            records[r.prevByCourse].nextByCourse = r.nextByCourse;
+        else
+            cl->head = r.nextByCourse;
+        if (r.nextByCourse >= 0)
+            records[r.nextByCourse].prevByCourse = r.prevByCourse;
+        else
+            cl->tail = r.prevByCourse;
+        if (--cl->count == 0)
+            byCourse.erase(courseID);
+
+        freeSlots.push_back(idx);
+        live--;
+        return true;
+    }
+
+    const CourseSet *takenBy(int studentID) const // NULL if no enrollments
+    {
+        const EnrollmentList *l = byStudent.find(studentID);
+        return l ? &takenSets[l->taken] : NULL;
+    }
+
+    int countForStudent(int studentID) const
+    {
+        const EnrollmentList *l = byStudent.find(studentID);
+        return l ? l->count : 0;
+    }
+
+    int countForCourse(int courseID) const
+    {
+        const EnrollmentList *l = byCourse.find(courseID);
+        return l ? l->count : 0;
+    }
+
+    template <typename Fn>
+    void forEachCourseOf(int studentID, Fn fn) const // fn(courseID), oldest first
+    {
+        const EnrollmentList *l = byStudent.find(studentID);
+        for (int i = l ? l->head : -1; i >= 0; i = records[i].nextByStudent)
+            fn(records[i].data.courseID);
+    }
+
+    template <typename Fn>
+    void forEachStudentIn(int courseID, Fn fn) const // fn(studentID), oldest first
+    {
+        const EnrollmentList *l = byCourse.find(courseID);
+        for (int i = l ? l->head : -1; i >= 0; i = records[i].nextByCourse)
+            fn(records[i].data.studentID);
+    }
+
+    template <typename Fn>
+    void forEach(Fn fn) const // fn(const Enrollment &), insertion order
+    {
+        for (int i = head; i >= 0; i = records[i].next)
+            fn(records[i].data);
+    }
+
+private:
+    static EnrollmentList &listFor(FlatIdMap<EnrollmentList> &index, int key)
+    {
+        EnrollmentList *l = index.find(key);
+        if (!l)
+        {
+            index.insert(key, EnrollmentList());
+            l = index.find(key);
+        }
+        return *l;
+    }
+};
+
+static const int WAITLIST_LEVELS = 4; // priority levels, e.g. by class standing
+
+class WaitlistItem
+{
+public:
+    int studentID;
+    int courseID;
+    int priority; // 0 .. WAITLIST_LEVELS-1, higher is served first
+};
+
+class WaitlistRecord
+{
+public:
+    WaitlistItem data;
+    int prev, next;               // global arrival order
+    int prevInQueue, nextInQueue; // the (course, priority) FIFO
+};
+
+// Per-course queues: one FIFO per priority level, served highest level first.
+class WaitlistQueue
+{
+public:
+    int head[WAITLIST_LEVELS] = {-1, -1, -1, -1};
+    int tail[WAITLIST_LEVELS] = {-1, -1, -1, -1};
+    int levelCount[WAITLIST_LEVELS] = {0, 0, 0, 0};
+    int count = 0;
+};
+
+// Waitlist entries for every course, in slots threaded on an index-linked FIFO
+// per (course, priority level) and on one global arrival order (snapshots,
+// listings). Enqueue, dequeue, removal and the duplicate check are O(1): the
+// (student, course) pair maps straight to its slot. Per-level counts give a new
+// entry's queue position without walking the queue.
+class WaitlistStore
+{
+public:
+    vector<WaitlistRecord> records;
+    vector<int> freeSlots;
+    int head = -1;
+    int tail = -1;
+    int live = 0;
+
+    FlatIdMap<int> slotByPair;
+    FlatIdMap<WaitlistQueue> byCourse;
+
+    int size() const { return live; }
+
+    void clear()
+    {
+        records.clear();
+        freeSlots.clear();
+        head = tail = -1;
+        live = 0;
+        slotByPair.clear();
+        byCourse.clear();
+    }
+
+    bool contains(int studentID, int courseID) const
+    {
+        return slotByPair.find(EnrollmentStore::pairKey(studentID, courseID)) != NULL;
+    }
+
+    int countFor(int courseID) const
+    {
+        const WaitlistQueue *q = byCourse.find(courseID);
+        return q ? q->count : 0;
+    }
+
+    void reserve(int n) // room for n more entries (bulk intake)
+    {
+        records.reserve(records.size() + n);
+        slotByPair.reserve(live + n);
+    }
+
+    // Returns the new entry's 1-based position in the course's service order,
+    // or 0 if the student is already waitlisted for the course.
+    int insert(int studentID, int courseID, int priority)
+    {
+        int idx = freeSlots.empty() ? (int)records.size() : freeSlots.back();
+        if (!slotByPair.insert(EnrollmentStore::pairKey(studentID, courseID), idx))
+            return 0;
+        if (idx == (int)records.size())
+            records.push_back(WaitlistRecord());
+        else
+            freeSlots.pop_back();
+
+        priority = max(0, min(WAITLIST_LEVELS - 1, priority));
+        WaitlistRecord &r = records[idx];
+        r.data.studentID = studentID;
+        r.data.courseID = courseID;
+        r.data.priority = priority;
+
+        r.prev = tail;
+        r.next = -1;
+        if (tail >= 0)
+            records[tail].next = idx;
+        else
+            head = idx;
+        tail = idx;
+
+        WaitlistQueue *q = byCourse.find(courseID);
+        if (!q)
+        {
+            byCourse.insert(courseID, WaitlistQueue());
+            q = byCourse.find(courseID);
+        }
+        r.prevInQueue = q->tail[priority];
+        r.nextInQueue = -1;
+        if (q->tail[priority] >= 0)
+            records[q->tail[priority]].nextInQueue = idx;
+        else
+            q->head[priority] = idx;
+        q->tail[priority] = idx;
+        q->levelCount[priority]++;
+        q->count++;
+
+        live++;
+        int position = 0;
+        for (int level = priority; level < WAITLIST_LEVELS; level++)
+            position += q->levelCount[level];
+        return position;
+    }
+
+    bool erase(int studentID, int courseID)
+    {
+        long long key = EnrollmentStore::pairKey(studentID, courseID);
+        int *slot = slotByPair.find(key);
+        if (!slot)
+            return false;
+        int idx = *slot;
+        slotByPair.erase(key);
+        WaitlistRecord &r = records[idx];
+
+        if (r.prev >= 0)
+            records[r.prev].next = r.next;
+        else
+            head = r.next;
+        if (r.next >= 0)
+            records[r.next].prev = r.prev;
+        else
+            tail = r.prev;
+
+        WaitlistQueue *q = byCourse.find(courseID);
+        int level = r.data.priority;
+        if (r.prevInQueue >= 0)
+            records[r.prevInQueue].nextInQueue = r.nextInQueue;
+        else
+            q->head[level] = r.nextInQueue;
+        if (r.nextInQueue >= 0)
+            records[r.nextInQueue].prevInQueue = r.prevInQueue;
+        else
+            q->tail[level] = r.prevInQueue;
+        q->levelCount[level]--;
+        if (--q->count == 0)
+            byCourse.erase(courseID);
+
+        freeSlots.push_back(idx);
+        live--;
+        return true;
+    }
+
+    // The entry the course serves next, or NULL if its waitlist is empty.
+    const WaitlistItem *front(int courseID) const
+    {
+        const WaitlistQueue *q = byCourse.find(courseID);
+        if (!q)
+            return NULL;
+        for (int level = WAITLIST_LEVELS - 1; level >= 0; level--)
+        {
+            if (q->head[level] >= 0)
+                return &records[q->head[level]].data;
+        }
+        return NULL;
+    }
+
+    const WaitlistItem *oldest() const
+    {
+        return head >= 0 ? &records[head].data : NULL;
+    }
+
+    template <typename Fn>
+    void forEachIn(int courseID, Fn fn) const // fn(const WaitlistItem &), service order
+    {
+        auto all = [&](const WaitlistItem &w)
+        {
+            fn(w);
+            return true;
+        };
+        scanIn(courseID, all);
+    }
+
+    template <typename Fn>
+    void scanIn(int courseID, Fn fn) const // like forEachIn, stops once fn returns false
+    {
+        const WaitlistQueue *q = byCourse.find(courseID);
+        for (int level = WAITLIST_LEVELS - 1; q && level >= 0; level--)
+        {
+            for (int i = q->head[level]; i >= 0; i = records[i].nextInQueue)
+            {
+                if (!fn(records[i].data))
+                    return;
+            }
+        }
+    }
+
+    template <typename Fn>
+    void forEach(Fn fn) const // fn(const WaitlistItem &), arrival order
+    {
+        for (int i = head; i >= 0; i = records[i].next)
+            fn(records[i].data);
+    }
+
+    int eraseCourse(int courseID)
+    {
+        vector<int> students;
+        forEachIn(courseID, [&](const WaitlistItem &w)
+                  { students.push_back(w.studentID); });
+        for (int id : students)
+            erase(id, courseID);
+        return (int)students.size();
+    }
+};
+
+enum JournalOp
+{
+    JOP_ADD_STUDENT = 1,
+    JOP_DELETE_STUDENT,
+    JOP_INSERT_COURSE,
+    JOP_DROP_COURSE,
+    JOP_ADD_PREREQ,
+    JOP_ADD_ENROLLMENT,
+    JOP_REMOVE_ENROLLMENT,
+    JOP_ENQUEUE_WAITLIST,
+    JOP_DEQUEUE_WAITLIST,
+    JOP_RESET_ALL,
+    JOP_SET_CAPACITY
+};
+
+// One journal entry: [u32 payload length][u32 crc32][u8 op][payload].
+// Mutations fill one of these and hand it to journalWrite().
+class JournalRecord
+{
+public:
+    string bytes;
+
+    explicit JournalRecord(JournalOp op)
+    {
+        bytes.assign(9, '\0');
+        bytes[8] = (char)op;
+    }
+
+    JournalRecord &i32(int32_t v)
+    {
+        bytes.append(reinterpret_cast<const char *>(&v), sizeof(v));
+        return *this;
+    }
+
+    JournalRecord &str(const string &v)
+    {
+        i32((int32_t)v.size());
+        bytes += v;
+        return *this;
+    }
+};
+
+extern StudentStore gStudents;
+extern CourseNode *gCourseRoot;
+extern NodePool<CourseNode> gCourseNodes;
+extern EnrollmentStore gEnrollments;
+
+extern WaitlistStore gWaitlists;
+
+extern FlatIdMap<Course *> courseTable; // courseID -> Course* owned by the AVL index
+
+void journalWrite(JournalRecord &rec);
+
+// journalWrite() records nothing while the journal is off or a JournalPause is
+// alive. Mutators test journalActive() first so they skip building the record.
+extern atomic<bool> gJournalEnabled;
+extern atomic<int> gJournalPauseDepth;
+
+inline bool journalActive()
+{
+    return gJournalEnabled.load(memory_order_relaxed) && gJournalPauseDepth.load(memory_order_relaxed) == 0;
+}
+
+// Outcome of a core operation; opResultText() gives a short user-facing reason.
+enum OpResult
+{
+    OP_OK = 0,
+    OP_NO_STUDENT,
+    OP_NO_COURSE,
+    OP_DUPLICATE, // student, enrollment or waitlist entry already exists
+    OP_NOT_FOUND,
+    OP_COURSE_FULL,
+    OP_PREREQS_MISSING,
+    OP_WAITLIST_FULL,
+    OP_WAITLIST_EMPTY,
+    OP_LIMIT_REACHED,
+    OP_CYCLE // a prerequisite would make a course depend on itself
+};
+
+const char *opResultText(OpResult r);
+
+// Core operations describe what they did through the current MessageSink, one
+// line per message without the trailing newline. With no sink installed the
+// messages are not even formatted, which is what bulk loads and benchmarks want.
+class MessageSink
+{
+public:
+    virtual ~MessageSink() {}
+    virtual void write(const char *msg, size_t len) = 0;
+    virtual void flush() {}
+};
+
+// Prints to cout. Buffered mode batches lines and writes them in one go every
+// FLUSH_BYTES or on flush(); unbuffered mode keeps interactive output in order.
+class ConsoleSink : public MessageSink
+{
+public:
+    static const size_t FLUSH_BYTES = 64 * 1024;
+    bool buffered;
+
+    explicit ConsoleSink(bool buffered = false) : buffered(buffered) {}
+    ~ConsoleSink() { flush(); }
+    void write(const char *msg, size_t len) override;
+    void flush() override;
+
+private:
+    string pending;
+};
+
+// Installs `sink` (NULL silences the core) for the calling thread and returns
+// the previous one, which is flushed first. Every thread starts with the shared
+// unbuffered ConsoleSink, which keeps no state between writes.
+MessageSink *setMessageSink(MessageSink *sink);
+MessageSink *messageSink();
+void flushMessages();
+void coreMessage(const char *fmt, ...);
+
+// Swaps in a sink for the lifetime of the scope.
+class ScopedMessageSink
+{
+public:
+    explicit ScopedMessageSink(MessageSink *sink) : previous(setMessageSink(sink)) {}
+    ~ScopedMessageSink() { setMessageSink(previous); }
+
+private:
+    MessageSink *previous;
+};
+
+// While any JournalPause is alive, journalWrite() records nothing (snapshot loads, replay).
+class JournalPause
+{
+public:
+    JournalPause();
+    ~JournalPause();
+};
+
+// Defers the durability wait of every journalWrite() in scope to the end of the
+// scope, so a bulk operation pays for one group commit instead of one per record.
+class JournalBatch
+{
+public:
+    JournalBatch();
+    ~JournalBatch();
+};
+
+// The courses a student still needs before (and including) a target course,
+// grouped into semesters. `result` is OP_OK when a plan exists.
+class DegreePlan
+{
+public:
+    int studentID = 0;
+    OpResult result = OP_OK;
+    vector<vector<int>> semesters; // course IDs, earliest term first
+    int courseCount = 0;
+    int credits = 0;
+    int unavailable = -1; // a required course that was dropped, if any
+};
+
+// Transitive prerequisite closure of every course, kept as a CourseSet over
+// gCourseIndex. Eligibility is a subset test of the course's closure against
+// the CourseSet of courses the student is enrolled in.
+//
+// Every change to a course's prerequisites goes through setCourse() or
+// removeCourse(), which recompute that course and, via the engine's reverse
+// adjacency, only the courses that depend on it. Between beginBatch() and
+// endBatch() the graph is updated but closures are rebuilt once at the end.
+//
+// The engine also keeps a topological order of all indices (prerequisites
+// first), maintained per edge with the Pearce-Kelly algorithm: an edge that
+// already agrees with the order costs O(1), otherwise only the indices between
+// its two endpoints are searched and reordered. That search is also what
+// detects an edge that would close a cycle.
+class PrereqEngine
+{
+public:
+    void clear();
+    void setCourse(int courseID, const int *prereqIDs, int count);
+    void addPrereq(int courseID, int prereqID);
+    void removeCourse(int courseID);
+
+    // Direct prerequisites of `courseID` in the order they were added, and the
+    // courses that list it directly. Both walks are O(degree).
+    int prereqCount(int courseID) const;
+    int dependantCount(int courseID) const;
+    bool hasPrereq(int courseID, int prereqID) const;
+
+    template <class Fn>
+    void forEachPrereq(int courseID, Fn fn) const // fn(prereqID)
+    {
+        int idx = gCourseIndex.find(courseID);
+        if (idx < 0 || idx >= (int)prereqsOf.size())
+            return;
+        for (int p : prereqsOf[idx])
+            fn(gCourseIndex.courseIdOf[p]);
+    }
+
+    template <class Fn>
+    void forEachDependant(int courseID, Fn fn) const // fn(dependantID), "unlocks"
+    {
+        int idx = gCourseIndex.find(courseID);
+        if (idx < 0 || idx >= (int)dependants.size())
+            return;
+        for (int d : dependants[idx])
+            fn(gCourseIndex.courseIdOf[d]);
+    }
+
+    void beginBatch();
+    void endBatch();
+
+    // True when making prereqID a prerequisite of courseID would let the
+    // course (transitively) require itself.
+    bool wouldCreateCycle(int courseID, int prereqID);
+
+    // Catalog courses grouped by longest prerequisite chain: layer 0 has no
+    // prerequisites, every course sits one layer above its deepest prerequisite.
+    void topologicalLayers(vector<vector<int>> &layers);
+
+    // True when `studentID` is enrolled in every transitive prerequisite of
+    // `course`; otherwise `missing` (if given) receives one course it lacks.
+    // A course outside the catalog has no prerequisites.
+    //
+    // The checks below are const and use no scratch, so any number of threads
+    // may run them at once without locks, as long as no thread is changing the
+    // graph or the enrollments meanwhile. Mutators still need exclusive access.
+    bool satisfied(int studentID, const Course &course, int *missing = NULL) const;
+
+    // The same test for a whole cohort: eligible[i] is set for studentIDs[i].
+    // Returns how many are eligible.
+    int satisfiedCohort(const Course &course, const int *studentIDs, int count, char *eligible) const;
+
+    // Fills plan.semesters with the courses the student is missing for
+    // `targetID` (the target included): each course comes after its missing
+    // prerequisites and each term stays within `creditCap` credits (a course
+    // worth more gets a term alone; a cap <= 0 means no cap). Terms are filled
+    // longest-remaining-chain first; without a cap that is the minimum number
+    // of terms, with one it is the usual list-scheduling heuristic.
+    void planSemesters(int studentID, int targetID, int creditCap, DegreePlan &plan) const;
+
+    // Every transitive prerequisite of a catalog course, or NULL if `courseID`
+    // is not in the catalog. Valid until the next graph change.
+    const CourseSet *closureOf(int courseID) const;
+
+private:
+    vector<char> live; // index currently names an existing course
+    vector<vector<int>> prereqsOf;  // direct prerequisites, dense
+    vector<vector<int>> dependants; // reverse of prereqsOf
+    vector<CourseSet> closure;
+    vector<int> ord;    // index -> position in the topological order
+    vector<int> nodeAt; // position -> index
+    bool cyclic = false; // legacy data holds a cycle, so `ord` is not trusted
+
+    int batchDepth = 0;
+    bool batchDirty = false;
+
+    // Scratch for the mutating calls only: a dense bitset, the words it touched,
+    // visit stamps for graph walks and the order being recomputed.
+    vector<uint64_t> dense;
+    vector<uint32_t> touched;
+    vector<uint32_t> stamp;
+    uint32_t epoch = 0;
+    vector<int> order;
+    CourseSet fresh;
+    vector<int> walkStack, deltaF, deltaB, slots;
+
+    int indexFor(int courseID);
+    void unlinkPrereqs(int idx);
+    bool reaches(int from, int target, int maxOrd);
+    void linkPrereq(int idx, int p);
+    void orWord(uint32_t word, uint64_t bits);
+    void collectClosure(const vector<int> &prereqs, CourseSet &out);
+    void recompute(const vector<int> &work);
+    void recomputeFrom(int idx);
+    void recomputeAll();
+    uint32_t nextEpoch();
+};
+
+extern PrereqEngine gPrereqs;
+
+// Defers closure maintenance to the end of the scope (snapshot loads, imports).
+class PrereqBatch
+{
+public:
+    PrereqBatch() { gPrereqs.beginBatch(); }
+    ~PrereqBatch() { gPrereqs.endBatch(); }
+};
+
+// ---- Prerequisite audit (ums_prereq.cpp) ----
+class AuditViolation
+{
+public:
+    int studentID;
+    int courseID;
+    int missingID; // one transitive prerequisite the student lacks
+};
+
+class AuditReport
+{
+public:
+    long coursesChecked = 0;
+    long enrollmentsChecked = 0;
+    vector<AuditViolation> violations; // grouped by course, roster order within
+    double seconds = 0;
+};
+
+// Checks every enrollment against the current prerequisite closures and
+// reports students enrolled in a course without all of its transitive
+// prerequisites (e.g. after a prerequisite was added to the course). Courses
+// are split across cores by roster size. Reads the live stores, so nothing
+// may change them until it returns.
+OpResult auditPrerequisites(AuditReport &report);
+
+// The same audit over a private copy of the data: capture() on the thread
+// that owns the stores, then run() on any thread while they keep changing.
+class AuditJob
+{
+public:
+    void capture();
+    void run(AuditReport &report) const;
+
+private:
+    EnrollmentStore enrollments;
+    vector<int> courseIDs;
+    vector<CourseSet> closures; // per courseIDs[i]
+    vector<int> courseIdOf;     // dense index -> course ID
+};
+
+// ---- Core operations (ums_core.cpp) ----
+// Splits [0, count) into contiguous ranges of at least minPerRange items, at
+// most one per core, and runs work(range, from, to) for each one. The first
+// range runs on the calling thread. parallelRangeCount() tells the caller
+// how many ranges there will be, so it can size per-range results.
+int parallelRangeCount(int count, int minPerRange);
+void parallelRanges(int count, int minPerRange, const function<void(int range, int from, int to)> &work);
+
+bool studentExists(int id);
+OpResult addStudent(int id, const string &name, const string &email,
+                    const string &phone, const string &address, const string &password);
+OpResult deleteStudent(int id);
+Student *searchStudentByID(int id);
+void sortStudentsByID();
+
+bool courseExists(int cID);
+Course *searchCourseByID(int cID);
+CourseNode *insertCourseBST(const Course &c, const int *prereqIDs = NULL, int prereqCount = 0);
+CourseNode *findMinCourseNode(CourseNode *node);
+void dropCourse(int cID);
+// Changes a course's capacity (0 = unlimited); any seats it opens are filled
+// from the waitlist.
+OpResult setCourseCapacity(int cID, int maxCapacity);
+void resetAllData();
+
+OpResult addEnrollment(int studentID, int courseID);
+// A freed seat is offered to the course's waitlist straight away.
+OpResult removeEnrollment(int studentID, int courseID);
+bool isStudentEnrolledInCourse(int studentID, int courseID);
+
+OpResult addPrerequisite(int courseID, int prereqID);
+bool checkPrerequisites(int studentID, const Course &course, bool verbose = false);
+bool meetsPrerequisites(int studentID, const Course &course);
+OpResult validatePrerequisites(int courseID, int studentID);
+
+// Checks every student against the prerequisites of `courseID`, split across
+// all cores. `count` receives how many are eligible; `onEligible`, if given,
+// is called on the calling thread with their IDs a batch at a time, in
+// student-store order.
+OpResult findEligibleStudents(int courseID, long *count,
+                              const function<void(const int *ids, int n)> &onEligible = nullptr);
+
+static const int DEFAULT_TERM_CREDITS = 18;
+
+// Semester plan for one student to reach `targetID` (see PrereqEngine::planSemesters).
+OpResult planDegreePath(int studentID, int targetID, int creditCap, DegreePlan &plan);
+// The same for every student in `studentIDs`, spread across cores; plans[i]
+// belongs to studentIDs[i] and carries its own result.
+OpResult planDegreePathCohort(const vector<int> &studentIDs, int targetID, int creditCap, vector<DegreePlan> &plans);
+
+OpResult enqueueWaitlist(int studentID, int courseID, int priority = 0);
+
+// One entry of a bulk waitlist intake; result and position are filled in.
+class WaitlistRequest
+{
+public:
+    int studentID = 0;
+    int courseID = 0;
+    int priority = 0;
+    OpResult result = OP_OK;
+    int position = 0; // 1-based place in the course's service order when queued
+};
+
+// Validates and queues every request in order, as enqueueWaitlist() would,
+// with one journal group commit for the batch. Returns how many were queued.
+int enqueueWaitlistBatch(vector<WaitlistRequest> &requests);
+OpResult dequeueWaitlist(int courseID);
+// Fills every open seat of the course from its waitlist in one pass and
+// returns how many students were enrolled.
+int promoteWaitlist(int courseID);
+
+// A seat request collected during a lottery window. After the draw, result is
+// OP_OK (enrolled), OP_COURSE_FULL (lost the draw and was waitlisted) or the
+// reason the request was refused.
+class LotteryEntry
+{
+public:
+    int studentID = 0;
+    int courseID = 0;
+    int standing = 0; // 0 .. WAITLIST_LEVELS-1: draw weight standing+1, and the waitlist priority
+    OpResult result = OP_OK;
+    double ticket = 0; // lower draws first; fixed by the seed, course and student
+};
+
+// Requests waiting for the next draw, at most one per (student, course).
+// The window lives in memory only; nothing is journalled until the draw.
+class LotteryWindow
+{
+public:
+    vector<LotteryEntry> entries;
+    FlatIdMap<int> slotByPair;
+
+    int size() const { return (int)entries.size(); }
+
+    void clear()
+    {
+        entries.clear();
+        slotByPair.clear();
+    }
+};
+
+extern LotteryWindow gLottery;
+
+class LotteryReport
+{
+public:
+    vector<LotteryEntry> entries; // grouped by course, each course in draw order
+    int courses = 0;
+    int enrolled = 0;
+    int waitlisted = 0;
+    int refused = 0;
+    double seconds = 0;
+};
+
+OpResult submitLotteryRequest(int studentID, int courseID, int standing = 0);
+// Closes the window and allocates every requested course's open seats by a
+// weighted draw: courses are drawn in parallel, then winners are enrolled
+// and the rest waitlisted in draw order. The same seed and window always give
+// the same allocation. Returns the number of students enrolled.
+int runSeatLottery(unsigned long long seed, LotteryReport &report);
+
+// Concurrent registration. Between beginRegistration() and endRegistration()
+// any number of threads may call registerEnrollment(); each course has its own
+// lock and seat counter for the session, so requests for different courses
+// never contend and a course never goes past maxCapacity. Accepted enrollments
+// are staged and committed (and journalled) by endRegistration(). While a
+// session is open nothing else may change the core: students, courses,
+// prerequisites and existing enrollments are read without locks, and
+// enrollments staged in the session do not count towards prerequisites.
+bool beginRegistration();
+OpResult registerEnrollment(int studentID, int courseID);
+int endRegistration();
+
+void initCourseHashTable();
+void insertCourseHash(Course *cPtr);
+Course *searchCourseHash(int cID);
+int rebuildHashFromBST(CourseNode *node);
+bool deleteCourseHash(int cID);
+
+// ---- Persistence (ums_storage.cpp) ----
+static const char *const SNAPSHOT_PATH = "ums_data.snap";
+
+void buildSnapshot(string &out, uint64_t journalGen = 0);
+bool writeFileAtomically(const char *path, const string &bytes);
+bool loadSnapshot(const char *path, uint64_t *journalGen = NULL);
+bool checkpointDatabase(bool background);
+bool revertToSnapshot();
+bool journalMaintenance();
+bool journalEnabled();
+bool recoverDatabase();
+void shutdownDatabase();
+bool bulkImport(const char *studentsPath, const char *coursesPath, const char *enrollmentsPath);
+
+// ---- Loopback JSON/HTTP API (ums_server.cpp, Linux epoll) ----
+// One event-loop thread owns the sockets (keep-alive, pipelining) and hands
+// parsed requests to a worker pool. Reads run side by side; anything that
+// changes the core runs alone, and one connection's writes apply in the order
+// they were sent. A write is answered once its journal records are durable.
+// While the server runs, nothing else may touch the core. When the request
+// queue or a connection's pipeline is full the loop stops reading from those
+// sockets until workers catch up.
+class ApiServerConfig
+{
+public:
+    int port = 8080;
+    int workers = 0;        // 0 = one per core, or at least 16 with the journal on (writers park on its flush)
+    int maxQueued = 4096;   // requests parsed but not yet answered, all connections
+    int maxPipeline = 64;   // unanswered requests per connection
+    int maxConnections = 1024;
+};
+
+class ApiServerStats
+{
+public:
+    long long connections = 0;
+    long long requests = 0;
+    long long errors = 0;      // malformed or oversized requests
+    long long checkpoints = 0; // journal generations started while serving
+};
+
+bool startApiServer(const ApiServerConfig &config);
+void stopApiServer();
+ApiServerStats apiServerStats();
+
+#endif
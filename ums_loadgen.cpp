@@ -0,0 +1,482 @@
+// Registration-rush load generator. Builds a synthetic catalog and population
+// (Zipf course popularity, prerequisite chains, capacities), then replays the
+// same scripted rush of enroll / waitlist / drop requests against each
+// registration backend and reports throughput and latency percentiles per
+// operation. Build together with the other ums_*.cpp files (no raylib), e.g.
+//   g++ -O2 -std=c++17 ums_loadgen.cpp ums_core.cpp ums_prereq.cpp ums_storage.cpp -o ums_loadgen -pthread
+// Settings are name=value arguments, e.g.
+//   ums_loadgen students=50000 courses=2000 requests=6 threads=8 backend=all
+#include "ums_core.h"
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+class LoadSpec
+{
+public:
+    int students = 20000;
+    int courses = 1000;
+    int requests = 6;      // enrollment requests per virtual student
+    double zipf = 1.1;     // popularity exponent; higher concentrates demand
+    double dropRate = 0.1; // share of successful enrollments dropped later
+    int threads = max(1, (int)thread::hardware_concurrency());
+    unsigned long long seed = 1;
+    string backend = "all";
+};
+
+// splitmix64 stream; every generated world and script depends only on the seed.
+class LoadRng
+{
+public:
+    unsigned long long state;
+
+    explicit LoadRng(unsigned long long seed) : state(seed) {}
+
+    unsigned long long next()
+    {
+        state += 0x9e3779b97f4a7c15ULL;
+        return mixHash64(state);
+    }
+
+    int below(int n) { return (int)(next() % (unsigned long long)n); }
+    double unit() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+};
+
+enum LoadOpKind
+{
+    LOAD_ENROLL,
+    LOAD_WAITLIST,
+    LOAD_DROP,
+    LOAD_OP_KINDS
+};
+
+static const char *loadOpName(int kind)
+{
+    static const char *names[LOAD_OP_KINDS] = {"addEnrollment", "enqueueWaitlist", "removeEnrollment"};
+    return names[kind];
+}
+
+// One scripted request. A student who finds the course full joins its
+// waitlist; an enrollment marked dropLater is dropped once the script ends.
+class LoadRequest
+{
+public:
+    int courseID;
+    bool dropLater;
+};
+
+class VirtualStudent
+{
+public:
+    int studentID;
+    vector<LoadRequest> script;
+};
+
+class LoadWorkload
+{
+public:
+    vector<VirtualStudent> population;
+    long requests = 0;
+};
+
+// Courses 1..courses form prerequisite chains of one to four courses. Every
+// student has already passed the opening courses of two chains, so requests
+// for later courses succeed or fail on prerequisites realistically.
+static void buildWorld(const LoadSpec &spec)
+{
+    resetAllData();
+    LoadRng rng(spec.seed);
+
+    vector<vector<int>> chains;
+    for (int k = 1; k <= spec.courses; k++)
+    {
+        if (chains.empty() || chains.back().size() >= 4 || rng.below(10) < 4)
+            chains.push_back(vector<int>());
+        chains.back().push_back(k);
+    }
+
+    {
+        PrereqBatch closures;
+        for (const vector<int> &chain : chains)
+        {
+            for (size_t i = 0; i < chain.size(); i++)
+            {
+                Course c;
+                c.courseID = chain[i];
+                c.courseName = "Course";
+                c.courseCredits = 3;
+                c.courseInstructor = "Staff";
+                c.maxCapacity = 0;
+                c.currentEnrolled = 0;
+                int prereq = i > 0 ? chain[i - 1] : 0;
+                insertCourseBST(c, &prereq, i > 0 ? 1 : 0);
+            }
+        }
+    }
+
+    gStudents.reserve(spec.students);
+    for (int s = 1; s <= spec.students; s++)
+    {
+        addStudent(s, "Student", "student@uni.edu", "555-0100", "Campus", "secret");
+        for (int pick = 0; pick < 2; pick++)
+        {
+            const vector<int> &chain = chains[rng.below((int)chains.size())];
+            int passed = rng.below((int)chain.size());
+            for (int i = 0; i < passed; i++)
+                addEnrollment(s, chain[i]);
+        }
+    }
+
+    // Capacities leave 20-200 open seats on top of past enrollments.
+    for (int k = 1; k <= spec.courses; k++)
+    {
+        Course *c = searchCourseByID(k);
+        c->maxCapacity = c->currentEnrolled + 20 + rng.below(181);
+    }
+}
+
+static LoadWorkload buildWorkload(const LoadSpec &spec)
+{
+    LoadRng rng(spec.seed ^ 0x5eedULL);
+
+    // Popularity rank r has weight 1/r^zipf; ranks are shuffled over courses
+    // so demand does not line up with the chain layout.
+    vector<int> byRank(spec.courses);
+    for (int i = 0; i < spec.courses; i++)
+        byRank[i] = i + 1;
+    for (int i = spec.courses - 1; i > 0; i--)
+        swap(byRank[i], byRank[rng.below(i + 1)]);
+    vector<double> cdf(spec.courses);
+    double total = 0;
+    for (int r = 0; r < spec.courses; r++)
+    {
+        total += 1.0 / pow(r + 1, spec.zipf);
+        cdf[r] = total;
+    }
+
+    LoadWorkload w;
+    w.population.resize(spec.students);
+    for (int s = 0; s < spec.students; s++)
+    {
+        VirtualStudent &v = w.population[s];
+        v.studentID = s + 1;
+        for (int j = 0; j < spec.requests; j++)
+        {
+            double u = rng.unit() * total;
+            int rank = (int)(lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin());
+            v.script.push_back({byRank[min(rank, spec.courses - 1)], rng.unit() < spec.dropRate});
+        }
+        w.requests += spec.requests;
+    }
+    return w;
+}
+
+// How the rush reaches the core. thread is the caller's worker index.
+class LoadBackend
+{
+public:
+    virtual ~LoadBackend() {}
+    virtual const char *name() const = 0;
+    virtual bool concurrent() const { return true; }
+    virtual void begin(int) {}
+    virtual OpResult enroll(int thread, int studentID, int courseID) = 0;
+    virtual OpResult waitlist(int thread, int studentID, int courseID) = 0;
+    virtual OpResult drop(int thread, int studentID, int courseID) = 0;
+    // Work the backend deferred during the rush. Per-op timings go into
+    // latencies; a kind applied as one batch has no per-op latency, so only
+    // the batch's total time goes into batchNanos.
+    virtual void finish(vector<vector<float>> &, vector<double> &) {}
+};
+
+// The unmodified core, one request at a time on one thread.
+class SerialBackend : public LoadBackend
+{
+public:
+    const char *name() const override { return "serial"; }
+    bool concurrent() const override { return false; }
+    OpResult enroll(int, int studentID, int courseID) override { return addEnrollment(studentID, courseID); }
+    OpResult waitlist(int, int studentID, int courseID) override { return enqueueWaitlist(studentID, courseID); }
+    OpResult drop(int, int studentID, int courseID) override { return removeEnrollment(studentID, courseID); }
+};
+
+// The unmodified core behind one global lock, so every thread queues for it.
+class LockedBackend : public LoadBackend
+{
+public:
+    mutex big;
+
+    const char *name() const override { return "locked"; }
+
+    OpResult enroll(int, int studentID, int courseID) override
+    {
+        lock_guard<mutex> hold(big);
+        return addEnrollment(studentID, courseID);
+    }
+
+    OpResult waitlist(int, int studentID, int courseID) override
+    {
+        lock_guard<mutex> hold(big);
+        return enqueueWaitlist(studentID, courseID);
+    }
+
+    OpResult drop(int, int studentID, int courseID) override
+    {
+        lock_guard<mutex> hold(big);
+        return removeEnrollment(studentID, courseID);
+    }
+};
+
+// Enrollments go through a registration session (per-course locks). The core
+// cannot change during a session, so waitlist joins and drops are collected
+// per thread and applied after it closes: the joins as one bulk intake, the
+// drops one by one (each may promote from the waitlist).
+class ShardedBackend : public LoadBackend
+{
+public:
+    vector<vector<WaitlistRequest>> joins;
+    vector<vector<WaitlistRequest>> drops;
+
+    const char *name() const override { return "sharded"; }
+
+    void begin(int threads) override
+    {
+        joins.assign(threads, vector<WaitlistRequest>());
+        drops.assign(threads, vector<WaitlistRequest>());
+        beginRegistration();
+    }
+
+    OpResult enroll(int, int studentID, int courseID) override { return registerEnrollment(studentID, courseID); }
+
+    OpResult waitlist(int thread, int studentID, int courseID) override
+    {
+        WaitlistRequest req;
+        req.studentID = studentID;
+        req.courseID = courseID;
+        joins[thread].push_back(req);
+        return OP_OK;
+    }
+
+    OpResult drop(int thread, int studentID, int courseID) override
+    {
+        WaitlistRequest req;
+        req.studentID = studentID;
+        req.courseID = courseID;
+        drops[thread].push_back(req);
+        return OP_OK;
+    }
+
+    void finish(vector<vector<float>> &latencies, vector<double> &batchNanos) override
+    {
+        endRegistration();
+
+        vector<WaitlistRequest> all;
+        for (vector<WaitlistRequest> &part : joins)
+            all.insert(all.end(), part.begin(), part.end());
+        chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+        enqueueWaitlistBatch(all);
+        batchNanos[LOAD_WAITLIST] = chrono::duration<double, nano>(chrono::steady_clock::now() - t0).count();
+
+        for (vector<WaitlistRequest> &part : drops)
+        {
+            for (const WaitlistRequest &req : part)
+            {
+                chrono::steady_clock::time_point start = chrono::steady_clock::now();
+                removeEnrollment(req.studentID, req.courseID);
+                latencies[LOAD_DROP].push_back(chrono::duration<float, nano>(chrono::steady_clock::now() - start).count());
+            }
+        }
+    }
+};
+
+class LoadCounters
+{
+public:
+    long ops[LOAD_OP_KINDS] = {0, 0, 0};
+    long enrolled = 0;
+    long full = 0;
+    long refused = 0; // prerequisites missing or already enrolled
+};
+
+// Worker t plays students t, t+threads, ... one script step at a time, so each
+// thread keeps many students in flight the way a real rush interleaves them.
+static void playRush(LoadBackend &backend, const LoadWorkload &w, int t, int threads,
+                     vector<vector<float>> &latencies, LoadCounters &counters)
+{
+    ScopedMessageSink quiet(NULL);
+    vector<const VirtualStudent *> mine;
+    for (size_t i = t; i < w.population.size(); i += threads)
+        mine.push_back(&w.population[i]);
+    vector<vector<int>> toDrop(mine.size());
+
+    auto record = [&](int kind, chrono::steady_clock::time_point start)
+    {
+        latencies[kind].push_back(chrono::duration<float, nano>(chrono::steady_clock::now() - start).count());
+        counters.ops[kind]++;
+    };
+
+    size_t steps = mine.empty() ? 0 : mine[0]->script.size();
+    for (size_t step = 0; step < steps; step++)
+    {
+        for (size_t i = 0; i < mine.size(); i++)
+        {
+            const VirtualStudent &v = *mine[i];
+            const LoadRequest &req = v.script[step];
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            OpResult r = backend.enroll(t, v.studentID, req.courseID);
+            record(LOAD_ENROLL, start);
+            if (r == OP_OK)
+            {
+                counters.enrolled++;
+                if (req.dropLater)
+                    toDrop[i].push_back(req.courseID);
+            }
+            else if (r == OP_COURSE_FULL)
+            {
+                counters.full++;
+                start = chrono::steady_clock::now();
+                backend.waitlist(t, v.studentID, req.courseID);
+                record(LOAD_WAITLIST, start);
+            }
+            else
+            {
+                counters.refused++;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < mine.size(); i++)
+    {
+        for (int courseID : toDrop[i])
+        {
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            backend.drop(t, mine[i]->studentID, courseID);
+            record(LOAD_DROP, start);
+        }
+    }
+}
+
+static double percentile(const vector<float> &sorted, double p)
+{
+    if (sorted.empty())
+        return 0;
+    size_t i = min(sorted.size() - 1, (size_t)(p * sorted.size()));
+    return sorted[i];
+}
+
+static void runBackend(LoadBackend &backend, const LoadSpec &spec, const LoadWorkload &w)
+{
+    buildWorld(spec);
+    int threads = backend.concurrent() ? spec.threads : 1;
+
+    vector<vector<vector<float>>> perThread(threads, vector<vector<float>>(LOAD_OP_KINDS));
+    vector<LoadCounters> counters(threads);
+    backend.begin(threads);
+
+    chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+    vector<thread> pool;
+    for (int t = 1; t < threads; t++)
+        pool.push_back(thread(playRush, ref(backend), cref(w), t, threads, ref(perThread[t]), ref(counters[t])));
+    playRush(backend, w, 0, threads, perThread[0], counters[0]);
+    for (thread &t : pool)
+        t.join();
+
+    // Deferred work replaces the in-rush timings of the operations it covers.
+    vector<vector<float>> deferred(LOAD_OP_KINDS);
+    vector<double> batchNanos(LOAD_OP_KINDS, -1);
+    backend.finish(deferred, batchNanos);
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+
+    LoadCounters sum;
+    for (const LoadCounters &c : counters)
+    {
+        for (int k = 0; k < LOAD_OP_KINDS; k++)
+            sum.ops[k] += c.ops[k];
+        sum.enrolled += c.enrolled;
+        sum.full += c.full;
+        sum.refused += c.refused;
+    }
+    long totalOps = sum.ops[LOAD_ENROLL] + sum.ops[LOAD_WAITLIST] + sum.ops[LOAD_DROP];
+
+    printf("\n[%s] %d thread(s): %ld ops in %.3f s = %.0f ops/s\n",
+           backend.name(), threads, totalOps, seconds, totalOps / seconds);
+    printf("  requests: %ld enrolled, %ld full (waitlisted), %ld refused\n", sum.enrolled, sum.full, sum.refused);
+    printf("  %-18s %10s %10s %10s %10s\n", "operation", "count", "p50 us", "p99 us", "p999 us");
+    for (int k = 0; k < LOAD_OP_KINDS; k++)
+    {
+        if (batchNanos[k] >= 0)
+        {
+            printf("  %-18s %10ld %10s %10s %10s  (one batch, %.2f ms)\n", loadOpName(k), sum.ops[k],
+                   "n/a", "n/a", "n/a", batchNanos[k] / 1e6);
+            continue;
+        }
+        vector<float> all = deferred[k];
+        if (all.empty())
+        {
+            for (const vector<vector<float>> &logs : perThread)
+                all.insert(all.end(), logs[k].begin(), logs[k].end());
+        }
+        sort(all.begin(), all.end());
+        printf("  %-18s %10zu %10.2f %10.2f %10.2f\n", loadOpName(k), all.size(),
+               percentile(all, 0.50) / 1000, percentile(all, 0.99) / 1000, percentile(all, 0.999) / 1000);
+    }
+    printf("  final: %d enrollments, %d waitlisted\n", gEnrollments.size(), gWaitlists.size());
+}
+
+int main(int argc, char **argv)
+{
+    LoadSpec spec;
+    for (int i = 1; i < argc; i++)
+    {
+        string arg = argv[i];
+        size_t eq = arg.find('=');
+        string key = arg.substr(0, eq);
+        string value = eq == string::npos ? "" : arg.substr(eq + 1);
+        if (key == "students")
+            spec.students = max(1, atoi(value.c_str()));
+        else if (key == "courses")
+            spec.courses = max(1, atoi(value.c_str()));
+        else if (key == "requests")
+            spec.requests = max(1, atoi(value.c_str()));
+        else if (key == "threads")
+            spec.threads = max(1, atoi(value.c_str()));
+        else if (key == "seed")
+            spec.seed = strtoull(value.c_str(), NULL, 10);
+        else if (key == "zipf")
+            spec.zipf = atof(value.c_str());
+        else if (key == "drop")
+            spec.dropRate = atof(value.c_str());
+        else if (key == "backend")
+            spec.backend = value;
+        else
+        {
+            printf("Unknown setting '%s'. Settings: students courses requests threads seed zipf drop backend\n",
+                   arg.c_str());
+            return 1;
+        }
+    }
+
+    setMessageSink(NULL);
+    printf("Load: %d students x %d requests over %d courses, zipf %.2f, seed %llu\n",
+           spec.students, spec.requests, spec.courses, spec.zipf, spec.seed);
+    LoadWorkload w = buildWorkload(spec);
+
+    SerialBackend serial;
+    LockedBackend locked;
+    ShardedBackend sharded;
+    LoadBackend *backends[] = {&serial, &locked, &sharded};
+    bool ran = false;
+    for (LoadBackend *b : backends)
+    {
+        if (spec.backend == "all" || spec.backend == b->name())
+        {
+            runBackend(*b, spec, w);
+            ran = true;
+        }
+    }
+    if (!ran)
+        printf("Unknown backend '%s' (serial, locked, sharded or all).\n", spec.backend.c_str());
+
+    resetAllData();
+    return ran ? 0 : 1;
+}
@@ -0,0 +1,801 @@
+#include "ums_core.h"
+#include <chrono>
+#include <climits>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define UMS_HAVE_SSE2 1
+#endif
+
+CourseIndex gCourseIndex;
+PrereqEngine gPrereqs;
+
+// True when every bit of need[0..k) is also set in have[0..k).
+static bool coversWords(const uint64_t *have, const uint64_t *need, size_t k)
+{
+    size_t t = 0;
+#ifdef UMS_HAVE_SSE2
+    __m128i lacking = _mm_setzero_si128();
+    for (; t + 2 <= k; t += 2)
+    {
+        __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i *>(have + t));
+        __m128i n = _mm_loadu_si128(reinterpret_cast<const __m128i *>(need + t));
+        lacking = _mm_or_si128(lacking, _mm_andnot_si128(h, n));
+    }
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(lacking, _mm_setzero_si128())) != 0xFFFF)
+        return false;
+#endif
+    for (; t < k; t++)
+    {
+        if (need[t] & ~have[t])
+            return false;
+    }
+    return true;
+}
+
+// Gathers, in blocks, the words of this set that line up with `need` and
+// compares each block at once; only a failing block is rescanned to name the
+// missing index.
+bool CourseSet::containsAll(const CourseSet &need, int *missing) const
+{
+    const size_t BLOCK = 16;
+    uint64_t have[BLOCK];
+    size_t j = 0;
+    size_t n = need.wordAt.size();
+    for (size_t i = 0; i < n; i += BLOCK)
+    {
+        size_t k = min(BLOCK, n - i);
+        for (size_t t = 0; t < k; t++)
+        {
+            uint32_t w = need.wordAt[i + t];
+            while (j < wordAt.size() && wordAt[j] < w)
+                j++;
+            have[t] = (j < wordAt.size() && wordAt[j] == w) ? bits[j] : 0;
+        }
+        if (coversWords(have, &need.bits[i], k))
+            continue;
+        for (size_t t = 0; t < k; t++)
+        {
+            uint64_t lacking = need.bits[i + t] & ~have[t];
+            if (lacking)
+            {
+                if (missing)
+                    *missing = (int)(need.wordAt[i + t] * 64 + __builtin_ctzll(lacking));
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void PrereqEngine::clear()
+{
+    live.clear();
+    prereqsOf.clear();
+    dependants.clear();
+    closure.clear();
+    ord.clear();
+    nodeAt.clear();
+    dense.clear();
+    stamp.clear();
+    cyclic = false;
+    batchDirty = false;
+}
+
+// The engine's per-index arrays trail gCourseIndex (enrollments intern IDs
+// too) and are extended on demand.
+int PrereqEngine::indexFor(int courseID)
+{
+    int idx = gCourseIndex.intern(courseID);
+    while ((int)live.size() <= idx)
+    {
+        int fresh = (int)live.size();
+        live.push_back(0);
+        prereqsOf.push_back(vector<int>());
+        dependants.push_back(vector<int>());
+        closure.push_back(CourseSet());
+        ord.push_back((int)nodeAt.size()); // no edges yet, so last is a valid place
+        nodeAt.push_back(fresh);
+        stamp.push_back(0);
+        if ((size_t)fresh / 64 >= dense.size())
+            dense.push_back(0);
+    }
+    return idx;
+}
+
+uint32_t PrereqEngine::nextEpoch()
+{
+    if (++epoch == 0)
+    {
+        fill(stamp.begin(), stamp.end(), 0);
+        epoch = 1;
+    }
+    return epoch;
+}
+
+void PrereqEngine::unlinkPrereqs(int idx)
+{
+    for (int p : prereqsOf[idx])
+    {
+        vector<int> &back = dependants[p];
+        for (size_t i = 0; i < back.size(); i++)
+        {
+            if (back[i] == idx)
+            {
+                back[i] = back.back();
+                back.pop_back();
+                break;
+            }
+        }
+    }
+    prereqsOf[idx].clear();
+}
+
+void PrereqEngine::setCourse(int courseID, const int *prereqIDs, int count)
+{
+    int idx = indexFor(courseID);
+    live[idx] = 1;
+    unlinkPrereqs(idx);
+    for (int i = 0; i < count; i++)
+    {
+        int p = indexFor(prereqIDs[i]);
+        if (find(prereqsOf[idx].begin(), prereqsOf[idx].end(), p) == prereqsOf[idx].end())
+            linkPrereq(idx, p);
+    }
+
+    if (batchDepth > 0)
+        batchDirty = true;
+    else
+        recomputeFrom(idx);
+}
+
+void PrereqEngine::addPrereq(int courseID, int prereqID)
+{
+    int idx = indexFor(courseID);
+    int p = indexFor(prereqID);
+    live[idx] = 1;
+    if (find(prereqsOf[idx].begin(), prereqsOf[idx].end(), p) != prereqsOf[idx].end())
+        return;
+    linkPrereq(idx, p);
+
+    if (batchDepth > 0)
+        batchDirty = true;
+    else
+        recomputeFrom(idx);
+}
+
+int PrereqEngine::prereqCount(int courseID) const
+{
+    int idx = gCourseIndex.find(courseID);
+    return (idx >= 0 && idx < (int)prereqsOf.size()) ? (int)prereqsOf[idx].size() : 0;
+}
+
+int PrereqEngine::dependantCount(int courseID) const
+{
+    int idx = gCourseIndex.find(courseID);
+    return (idx >= 0 && idx < (int)dependants.size()) ? (int)dependants[idx].size() : 0;
+}
+
+bool PrereqEngine::hasPrereq(int courseID, int prereqID) const
+{
+    int idx = gCourseIndex.find(courseID);
+    int p = gCourseIndex.find(prereqID);
+    if (idx < 0 || p < 0 || idx >= (int)prereqsOf.size())
+        return false;
+    return find(prereqsOf[idx].begin(), prereqsOf[idx].end(), p) != prereqsOf[idx].end();
+}
+
+// Walks dependants from `from`, skipping anything placed after maxOrd, and
+// leaves the visited indices in deltaF. True if `target` was reached.
+bool PrereqEngine::reaches(int from, int target, int maxOrd)
+{
+    deltaF.clear();
+    walkStack.clear();
+    uint32_t seen = nextEpoch();
+    stamp[from] = seen;
+    walkStack.push_back(from);
+    while (!walkStack.empty())
+    {
+        int node = walkStack.back();
+        walkStack.pop_back();
+        if (node == target)
+            return true;
+        deltaF.push_back(node);
+        for (int d : dependants[node])
+        {
+            if (stamp[d] != seen && ord[d] <= maxOrd)
+            {
+                stamp[d] = seen;
+                walkStack.push_back(d);
+            }
+        }
+    }
+    return false;
+}
+
+bool PrereqEngine::wouldCreateCycle(int courseID, int prereqID)
+{
+    if (courseID == prereqID)
+        return true;
+    int c = gCourseIndex.find(courseID);
+    int p = gCourseIndex.find(prereqID);
+    if (c < 0 || p < 0 || c >= (int)live.size() || p >= (int)live.size())
+        return false; // an ID the engine has never linked has no edges
+    bool ordered = !cyclic && batchDepth == 0;
+    if (ordered && ord[p] < ord[c])
+        return false;
+    return reaches(c, p, ordered ? ord[p] : INT_MAX);
+}
+
+// Adds the edge p -> idx (p is a prerequisite of idx). If p is currently
+// placed after idx, the dependants of idx placed before p (deltaF) and the
+// prerequisites of p placed after idx (deltaB) swap into the same set of
+// positions, deltaB first, each keeping its relative order.
+void PrereqEngine::linkPrereq(int idx, int p)
+{
+    prereqsOf[idx].push_back(p);
+    dependants[p].push_back(idx);
+    if (batchDepth > 0 || cyclic)
+        return;
+
+    int lb = ord[idx];
+    int ub = ord[p];
+    if (ub < lb)
+        return;
+    if (reaches(idx, p, ub))
+    {
+        cyclic = true; // only unchecked legacy data gets here
+        return;
+    }
+
+    deltaB.clear();
+    walkStack.clear();
+    uint32_t seen = nextEpoch();
+    stamp[p] = seen;
+    walkStack.push_back(p);
+    while (!walkStack.empty())
+    {
+        int node = walkStack.back();
+        walkStack.pop_back();
+        deltaB.push_back(node);
+        for (int q : prereqsOf[node])
+        {
+            if (stamp[q] != seen && ord[q] >= lb)
+            {
+                stamp[q] = seen;
+                walkStack.push_back(q);
+            }
+        }
+    }
+
+    auto byOrd = [&](int a, int b)
+    { return ord[a] < ord[b]; };
+    sort(deltaB.begin(), deltaB.end(), byOrd);
+    sort(deltaF.begin(), deltaF.end(), byOrd);
+    slots.clear();
+    for (int x : deltaB)
+        slots.push_back(ord[x]);
+    for (int x : deltaF)
+        slots.push_back(ord[x]);
+    sort(slots.begin(), slots.end());
+
+    size_t k = 0;
+    for (int x : deltaB)
+    {
+        ord[x] = slots[k];
+        nodeAt[slots[k++]] = x;
+    }
+    for (int x : deltaF)
+    {
+        ord[x] = slots[k];
+        nodeAt[slots[k++]] = x;
+    }
+}
+
+void PrereqEngine::topologicalLayers(vector<vector<int>> &layers)
+{
+    layers.clear();
+    vector<int> depth(live.size(), 0);
+    for (int idx : nodeAt)
+    {
+        if (!live[idx])
+            continue;
+        int d = 0;
+        for (int p : prereqsOf[idx])
+        {
+            if (live[p] && depth[p] + 1 > d)
+                d = depth[p] + 1;
+        }
+        depth[idx] = d;
+        if (d >= (int)layers.size())
+            layers.resize(d + 1);
+        layers[d].push_back(gCourseIndex.courseIdOf[idx]);
+    }
+}
+
+// A dropped course is still required by the courses that list it (nobody can
+// enroll in it any more), but its own prerequisites stop being inherited.
+void PrereqEngine::removeCourse(int courseID)
+{
+    int idx = gCourseIndex.find(courseID);
+    if (idx < 0 || idx >= (int)live.size())
+        return;
+    live[idx] = 0;
+    unlinkPrereqs(idx);
+
+    if (batchDepth > 0)
+        batchDirty = true;
+    else
+        recomputeFrom(idx);
+}
+
+void PrereqEngine::beginBatch()
+{
+    batchDepth++;
+}
+
+void PrereqEngine::endBatch()
+{
+    if (--batchDepth == 0 && batchDirty)
+    {
+        batchDirty = false;
+        recomputeAll();
+    }
+}
+
+void PrereqEngine::orWord(uint32_t word, uint64_t bits)
+{
+    if (dense[word] == 0)
+        touched.push_back(word);
+    dense[word] |= bits;
+}
+
+// closure(course) = union over direct prerequisites p of {p} + closure(p).
+void PrereqEngine::collectClosure(const vector<int> &prereqs, CourseSet &out)
+{
+    touched.clear();
+    for (int p : prereqs)
+    {
+        orWord((uint32_t)p / 64, 1ULL << (p % 64));
+        if (!live[p])
+            continue;
+        const CourseSet &inherited = closure[p];
+        for (size_t i = 0; i < inherited.wordAt.size(); i++)
+            orWord(inherited.wordAt[i], inherited.bits[i]);
+    }
+
+    sort(touched.begin(), touched.end());
+    out.clear();
+    for (uint32_t w : touched)
+    {
+        out.wordAt.push_back(w);
+        out.bits.push_back(dense[w]);
+        dense[w] = 0;
+    }
+}
+
+// Recomputes every index in `work`, which should list prerequisites before
+// their dependants. Closures in `work` are rebuilt from empty; if a course
+// changes after one of its dependants was already done in this sweep (only
+// possible with a cycle) the set is swept again until nothing changes.
+void PrereqEngine::recompute(const vector<int> &work)
+{
+    for (int idx : work)
+        closure[idx].clear();
+
+    bool again = true;
+    while (again)
+    {
+        again = false;
+        uint32_t done = nextEpoch();
+        for (int idx : work)
+        {
+            collectClosure(prereqsOf[idx], fresh);
+            if (!fresh.sameAs(closure[idx]))
+            {
+                swap(closure[idx], fresh);
+                for (int d : dependants[idx])
+                {
+                    if (stamp[d] == done)
+                        again = true;
+                }
+            }
+            stamp[idx] = done;
+        }
+    }
+}
+
+// Only `idx` and the courses that (transitively) depend on it can change.
+// A depth-first walk over the reverse adjacency yields them in reverse
+// topological order.
+void PrereqEngine::recomputeFrom(int idx)
+{
+    order.clear();
+    uint32_t seen = nextEpoch();
+    vector<pair<int, size_t>> walk;
+    walk.push_back(make_pair(idx, (size_t)0));
+    stamp[idx] = seen;
+    while (!walk.empty())
+    {
+        int node = walk.back().first;
+        size_t &next = walk.back().second;
+        if (next < dependants[node].size())
+        {
+            int d = dependants[node][next++];
+            if (stamp[d] != seen)
+            {
+                stamp[d] = seen;
+                walk.push_back(make_pair(d, (size_t)0));
+            }
+            continue;
+        }
+        order.push_back(node);
+        walk.pop_back();
+    }
+    reverse(order.begin(), order.end());
+    vector<int> work;
+    work.swap(order);
+    recompute(work);
+}
+
+// Post-order over prerequisite edges puts every course after its prerequisites,
+// which also becomes the new topological order.
+void PrereqEngine::recomputeAll()
+{
+    order.clear();
+    uint32_t seen = nextEpoch();
+    vector<pair<int, size_t>> walk;
+    for (int root = 0; root < (int)live.size(); root++)
+    {
+        if (stamp[root] == seen)
+            continue;
+        stamp[root] = seen;
+        walk.push_back(make_pair(root, (size_t)0));
+        while (!walk.empty())
+        {
+            int node = walk.back().first;
+            size_t &next = walk.back().second;
+            if (next < prereqsOf[node].size())
+            {
+                int p = prereqsOf[node][next++];
+                if (stamp[p] != seen)
+                {
+                    stamp[p] = seen;
+                    walk.push_back(make_pair(p, (size_t)0));
+                }
+                continue;
+            }
+            order.push_back(node);
+            walk.pop_back();
+        }
+    }
+    vector<int> work;
+    work.swap(order);
+    for (int pos = 0; pos < (int)work.size(); pos++)
+    {
+        ord[work[pos]] = pos;
+        nodeAt[pos] = work[pos];
+    }
+    cyclic = false;
+    for (int idx = 0; idx < (int)prereqsOf.size() && !cyclic; idx++)
+    {
+        for (int p : prereqsOf[idx])
+        {
+            if (ord[p] >= ord[idx])
+                cyclic = true;
+        }
+    }
+    recompute(work);
+}
+
+const CourseSet *PrereqEngine::closureOf(int courseID) const
+{
+    int idx = gCourseIndex.find(courseID);
+    if (idx >= 0 && idx < (int)live.size() && live[idx])
+        return &closure[idx];
+    return NULL;
+}
+
+bool PrereqEngine::satisfied(int studentID, const Course &course, int *missing) const
+{
+    const CourseSet *need = closureOf(course.courseID);
+    if (!need || need->empty())
+        return true;
+
+    const CourseSet *have = gEnrollments.takenBy(studentID);
+    int missingIdx = need->wordAt[0] * 64 + __builtin_ctzll(need->bits[0]);
+    if (have && have->containsAll(*need, &missingIdx))
+        return true;
+    if (missing)
+        *missing = gCourseIndex.courseIdOf[missingIdx];
+    return false;
+}
+
+int PrereqEngine::satisfiedCohort(const Course &course, const int *studentIDs, int count, char *eligible) const
+{
+    const CourseSet *need = closureOf(course.courseID);
+    int total = 0;
+    bool anyone = !need || need->empty();
+    for (int i = 0; i < count; i++)
+    {
+        const CourseSet *have = anyone ? NULL : gEnrollments.takenBy(studentIDs[i]);
+        eligible[i] = anyone || (have && have->containsAll(*need));
+        total += eligible[i];
+    }
+    return total;
+}
+
+void PrereqEngine::planSemesters(int studentID, int targetID, int creditCap, DegreePlan &plan) const
+{
+    plan.studentID = studentID;
+    plan.result = OP_OK;
+    plan.semesters.clear();
+    plan.courseCount = 0;
+    plan.credits = 0;
+    plan.unavailable = -1;
+
+    const CourseSet *need = closureOf(targetID);
+    if (!need)
+    {
+        plan.result = OP_NO_COURSE;
+        return;
+    }
+    const CourseSet *have = gEnrollments.takenBy(studentID);
+    int target = gCourseIndex.find(targetID);
+
+    // Missing indices in ascending order, so posOf() can binary search them.
+    vector<int> missing;
+    for (size_t w = 0; w < need->wordAt.size(); w++)
+    {
+        uint64_t bits = need->bits[w];
+        while (bits)
+        {
+            int idx = (int)(need->wordAt[w] * 64 + __builtin_ctzll(bits));
+            bits &= bits - 1;
+            if (!have || !have->has(idx))
+                missing.push_back(idx);
+        }
+    }
+    if (!have || !have->has(target))
+        missing.insert(lower_bound(missing.begin(), missing.end(), target), target);
+    int m = (int)missing.size();
+    if (m == 0)
+        return;
+
+    auto posOf = [&](int idx)
+    {
+        auto it = lower_bound(missing.begin(), missing.end(), idx);
+        return (it != missing.end() && *it == idx) ? (int)(it - missing.begin()) : -1;
+    };
+
+    vector<int> waiting(m, 0), credits(m, 0);
+    for (int i = 0; i < m; i++)
+    {
+        int idx = missing[i];
+        if (!live[idx])
+        {
+            plan.result = OP_NOT_FOUND;
+            plan.unavailable = gCourseIndex.courseIdOf[idx];
+            return;
+        }
+        for (int p : prereqsOf[idx])
+        {
+            if (posOf(p) >= 0)
+                waiting[i]++;
+        }
+        const Course *c = searchCourseByID(gCourseIndex.courseIdOf[idx]);
+        credits[i] = (c && c->courseCredits > 0) ? c->courseCredits : 0;
+    }
+
+    // Topological order of the missing courses, then the longest chain of
+    // missing courses that each one still has to open (itself included).
+    vector<int> order, left(waiting);
+    order.reserve(m);
+    for (int i = 0; i < m; i++)
+    {
+        if (left[i] == 0)
+            order.push_back(i);
+    }
+    for (size_t k = 0; k < order.size(); k++)
+    {
+        for (int d : dependants[missing[order[k]]])
+        {
+            int j = posOf(d);
+            if (j >= 0 && --left[j] == 0)
+                order.push_back(j);
+        }
+    }
+    if ((int)order.size() != m)
+    {
+        plan.result = OP_CYCLE; // only legacy data that predates cycle checks
+        return;
+    }
+    vector<int> chain(m, 1);
+    for (int k = m - 1; k >= 0; k--)
+    {
+        int i = order[k];
+        for (int d : dependants[missing[i]])
+        {
+            int j = posOf(d);
+            if (j >= 0 && chain[j] + 1 > chain[i])
+                chain[i] = chain[j] + 1;
+        }
+    }
+
+    if (creditCap <= 0)
+        creditCap = INT_MAX;
+    auto lessUrgent = [&](int a, int b)
+    {
+        if (chain[a] != chain[b])
+            return chain[a] < chain[b];
+        return missing[a] > missing[b];
+    };
+
+    // Courses whose missing prerequisites all sit in earlier terms wait in one
+    // heap per distinct credit value (ascending). A term repeatedly takes the
+    // most urgent top among the heaps that still fit, which is what scanning
+    // one urgency-sorted list for the first course that fits would pick,
+    // without rescanning the courses that don't.
+    vector<int> values(credits);
+    sort(values.begin(), values.end());
+    values.erase(unique(values.begin(), values.end()), values.end());
+    vector<vector<int>> ready(values.size());
+    vector<int> bucketOf(m);
+    for (int i = 0; i < m; i++)
+        bucketOf[i] = (int)(lower_bound(values.begin(), values.end(), credits[i]) - values.begin());
+    auto makeReady = [&](int i)
+    {
+        vector<int> &h = ready[bucketOf[i]];
+        h.push_back(i);
+        push_heap(h.begin(), h.end(), lessUrgent);
+    };
+    for (int i = 0; i < m; i++)
+    {
+        if (waiting[i] == 0)
+            makeReady(i);
+    }
+
+    vector<int> term;
+    int placed = 0;
+    while (placed < m)
+    {
+        term.clear();
+        long long used = 0;
+        while (true)
+        {
+            int best = -1;
+            for (size_t v = 0; v < values.size(); v++)
+            {
+                if (!term.empty() && used + values[v] > creditCap)
+                    break;
+                if (!ready[v].empty() && (best < 0 || lessUrgent(ready[best].front(), ready[v].front())))
+                    best = (int)v;
+            }
+            if (best < 0)
+                break;
+            vector<int> &h = ready[best];
+            pop_heap(h.begin(), h.end(), lessUrgent);
+            term.push_back(h.back());
+            h.pop_back();
+            used += values[best];
+        }
+
+        plan.semesters.push_back(vector<int>());
+        vector<int> &ids = plan.semesters.back();
+        for (int i : term)
+        {
+            ids.push_back(gCourseIndex.courseIdOf[missing[i]]);
+            plan.credits += credits[i];
+            for (int d : dependants[missing[i]])
+            {
+                int j = posOf(d);
+                if (j >= 0 && --waiting[j] == 0)
+                    makeReady(j);
+            }
+        }
+        placed += (int)term.size();
+    }
+    plan.courseCount = m;
+}
+
+// Below this many enrollments per thread, spawning costs more than it saves.
+static const long AUDIT_MIN_ENROLLMENTS = 1 << 15;
+
+// Audits courseIDs[i] against closures[i] using the rosters and student sets
+// in `enr`. Ranges of courses with roughly equal enrollment totals run in
+// parallel; their violations are concatenated in course order.
+static void auditCourses(const EnrollmentStore &enr, const vector<int> &courseIDs,
+                         const vector<const CourseSet *> &closures,
+                         const vector<int> &courseIdOf, AuditReport &report)
+{
+    chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+    int courses = (int)courseIDs.size();
+    vector<long> before(courses + 1, 0); // enrollments in courses [0, i)
+    for (int i = 0; i < courses; i++)
+    {
+        const EnrollmentList *l = enr.byCourse.find(courseIDs[i]);
+        before[i + 1] = before[i] + (l ? l->count : 0);
+    }
+    long total = before[courses];
+
+    int ranges = parallelRangeCount((int)min<long>(total, INT_MAX), (int)AUDIT_MIN_ENROLLMENTS);
+    vector<int> cut(ranges + 1, courses);
+    cut[0] = 0;
+    for (int r = 1; r < ranges; r++)
+        cut[r] = (int)(lower_bound(before.begin(), before.end(), total * r / ranges) - before.begin());
+
+    vector<vector<AuditViolation>> found(ranges);
+    auto work = [&](int, int from, int to)
+    {
+        for (int r = from; r < to; r++)
+        {
+            for (int i = cut[r]; i < cut[r + 1]; i++)
+            {
+                const CourseSet &need = *closures[i];
+                if (need.empty())
+                    continue;
+                int courseID = courseIDs[i];
+                auto check = [&](int studentID)
+                {
+                    const CourseSet *have = enr.takenBy(studentID);
+                    int missing = need.wordAt[0] * 64 + __builtin_ctzll(need.bits[0]);
+                    if (!have || !have->containsAll(need, &missing))
+                        found[r].push_back({studentID, courseID, courseIdOf[missing]});
+                };
+                enr.forEachStudentIn(courseID, check);
+            }
+        }
+    };
+    parallelRanges(ranges, 1, work);
+
+    report.coursesChecked = courses;
+    report.enrollmentsChecked = total;
+    report.violations.clear();
+    for (vector<AuditViolation> &part : found)
+        report.violations.insert(report.violations.end(), part.begin(), part.end());
+    report.seconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+}
+
+OpResult auditPrerequisites(AuditReport &report)
+{
+    vector<int> courseIDs;
+    vector<const CourseSet *> closures;
+    for (int id : gCourseIndex.courseIdOf)
+    {
+        const CourseSet *need = gPrereqs.closureOf(id);
+        if (need)
+        {
+            courseIDs.push_back(id);
+            closures.push_back(need);
+        }
+    }
+    auditCourses(gEnrollments, courseIDs, closures, gCourseIndex.courseIdOf, report);
+    coreMessage("Audited %ld enrollments in %ld courses: %d violations (%.3fs).",
+                report.enrollmentsChecked, report.coursesChecked, (int)report.violations.size(), report.seconds);
+    return OP_OK;
+}
+
+void AuditJob::capture()
+{
+    enrollments = gEnrollments;
+    courseIdOf = gCourseIndex.courseIdOf;
+    courseIDs.clear();
+    closures.clear();
+    for (int id : courseIdOf)
+    {
+        const CourseSet *need = gPrereqs.closureOf(id);
+        if (need)
+        {
+            courseIDs.push_back(id);
+            closures.push_back(*need);
+        }
+    }
+}
+
+void AuditJob::run(AuditReport &report) const
+{
+    vector<const CourseSet *> needs;
+    needs.reserve(closures.size());
+    for (const CourseSet &c : closures)
+        needs.push_back(&c);
+    auditCourses(enrollments, courseIDs, needs, courseIdOf, report);
+}
@@ -0,0 +1,1327 @@
+// Loopback JSON/HTTP API over the core operations. See ums_core.h for the
+// threading contract; the endpoints are listed above routeRead/routeWrite.
+#include "ums_core.h"
+
+#ifdef __linux__
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+static const size_t API_MAX_HEAD = 16 * 1024;
+static const long API_MAX_BODY = 1024 * 1024;
+static const size_t API_READ_CHUNK = 64 * 1024; // per readiness event, so one client cannot starve the rest
+static const int API_MAINTENANCE_MS = 100;
+
+// ---- JSON ----
+
+// Request bodies are flat objects: {"key": "text" | number | true | [int, ...]}.
+class JsonBody
+{
+public:
+    vector<pair<string, string>> values; // strings unescaped, other scalars as written
+    vector<pair<string, vector<int>>> lists;
+
+    const string *find(const char *key) const
+    {
+        for (const pair<string, string> &v : values)
+        {
+            if (v.first == key)
+                return &v.second;
+        }
+        return NULL;
+    }
+
+    bool getInt(const char *key, int &out) const
+    {
+        const string *v = find(key);
+        if (!v || v->empty())
+            return false;
+        char *end;
+        errno = 0;
+        long n = strtol(v->c_str(), &end, 10);
+        if (*end || errno || n < INT_MIN || n > INT_MAX)
+            return false;
+        out = (int)n;
+        return true;
+    }
+
+    string getText(const char *key) const
+    {
+        const string *v = find(key);
+        return v ? *v : string();
+    }
+
+    const vector<int> *getList(const char *key) const
+    {
+        for (const pair<string, vector<int>> &l : lists)
+        {
+            if (l.first == key)
+                return &l.second;
+        }
+        return NULL;
+    }
+};
+
+static void skipJsonSpace(const string &s, size_t &i)
+{
+    while (i < s.size() && isspace((unsigned char)s[i]))
+        i++;
+}
+
+static bool parseJsonString(const string &s, size_t &i, string &out)
+{
+    if (i >= s.size() || s[i] != '"')
+        return false;
+    i++;
+    while (i < s.size() && s[i] != '"')
+    {
+        char ch = s[i++];
+        if (ch != '\\')
+        {
+            out += ch;
+            continue;
+        }
+        if (i >= s.size())
+            return false;
+        char esc = s[i++];
+        if (esc == 'n')
+            out += '\n';
+        else if (esc == 't')
+            out += '\t';
+        else if (esc == 'r')
+            out += '\r';
+        else if (esc == 'b')
+            out += '\b';
+        else if (esc == 'f')
+            out += '\f';
+        else if (esc == 'u')
+        {
+            if (i + 4 > s.size())
+                return false;
+            unsigned code = (unsigned)strtoul(s.substr(i, 4).c_str(), NULL, 16);
+            i += 4;
+            out += code < 0x80 ? (char)code : '?'; // the stores hold plain text
+        }
+        else
+            out += esc;
+    }
+    if (i >= s.size())
+        return false;
+    i++;
+    return true;
+}
+
+static bool parseJsonBody(const string &s, JsonBody &body)
+{
+    size_t i = 0;
+    skipJsonSpace(s, i);
+    if (i == s.size())
+        return true; // no body, no fields
+    if (s[i++] != '{')
+        return false;
+    skipJsonSpace(s, i);
+    if (i < s.size() && s[i] == '}')
+    {
+        i++;
+        skipJsonSpace(s, i);
+        return i == s.size();
+    }
+
+    while (true)
+    {
+        string key;
+        skipJsonSpace(s, i);
+        if (!parseJsonString(s, i, key))
+            return false;
+        skipJsonSpace(s, i);
+        if (i >= s.size() || s[i++] != ':')
+            return false;
+        skipJsonSpace(s, i);
+        if (i >= s.size())
+            return false;
+
+        if (s[i] == '"')
+        {
+            string value;
+            if (!parseJsonString(s, i, value))
+                return false;
+            body.values.push_back({key, value});
+        }
+        else if (s[i] == '[')
+        {
+            i++;
+            vector<int> list;
+            skipJsonSpace(s, i);
+            while (i < s.size() && s[i] != ']')
+            {
+                char *end;
+                long n = strtol(s.c_str() + i, &end, 10);
+                if (end == s.c_str() + i || n < INT_MIN || n > INT_MAX)
+                    return false;
+                list.push_back((int)n);
+                i = end - s.c_str();
+                skipJsonSpace(s, i);
+                if (i < s.size() && s[i] == ',')
+                {
+                    i++;
+                    skipJsonSpace(s, i);
+                }
+            }
+            if (i >= s.size())
+                return false;
+            i++;
+            body.lists.push_back({key, list});
+        }
+        else
+        {
+            size_t start = i;
+            while (i < s.size() && (isalnum((unsigned char)s[i]) || s[i] == '-' || s[i] == '+' || s[i] == '.'))
+                i++;
+            if (i == start)
+                return false;
+            body.values.push_back({key, s.substr(start, i - start)});
+        }
+
+        skipJsonSpace(s, i);
+        if (i < s.size() && s[i] == ',')
+        {
+            i++;
+            continue;
+        }
+        if (i < s.size() && s[i] == '}')
+        {
+            i++;
+            break;
+        }
+        return false;
+    }
+    skipJsonSpace(s, i);
+    return i == s.size();
+}
+
+static void appendJsonString(string &out, const string &v)
+{
+    out += '"';
+    for (char ch : v)
+    {
+        if (ch == '"' || ch == '\\')
+        {
+            out += '\\';
+            out += ch;
+        }
+        else if ((unsigned char)ch < 0x20)
+        {
+            char esc[8];
+            snprintf(esc, sizeof(esc), "\\u%04x", (unsigned char)ch);
+            out += esc;
+        }
+        else
+            out += ch;
+    }
+    out += '"';
+}
+
+// Builds one response object field by field.
+class JsonOut
+{
+public:
+    string text = "{";
+
+    JsonOut &key(const char *k)
+    {
+        if (text.size() > 1)
+            text += ',';
+        appendJsonString(text, k);
+        text += ':';
+        return *this;
+    }
+
+    JsonOut &num(const char *k, long long v)
+    {
+        key(k);
+        text += to_string(v);
+        return *this;
+    }
+
+    JsonOut &str(const char *k, const string &v)
+    {
+        key(k);
+        appendJsonString(text, v);
+        return *this;
+    }
+
+    JsonOut &flag(const char *k, bool v)
+    {
+        key(k);
+        text += v ? "true" : "false";
+        return *this;
+    }
+
+    JsonOut &raw(const char *k, const string &json) // arrays and nested objects
+    {
+        key(k);
+        text += json;
+        return *this;
+    }
+
+    string done() const { return text + "}"; }
+};
+
+static string jsonIntList(const vector<int> &ids)
+{
+    string out = "[";
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        if (i)
+            out += ',';
+        out += to_string(ids[i]);
+    }
+    return out + "]";
+}
+
+// ---- Request handling (worker threads) ----
+
+class ApiReply
+{
+public:
+    int status = 200;
+    JsonOut out;
+};
+
+// Core messages printed while a request runs are returned as "messages".
+class CaptureSink : public MessageSink
+{
+public:
+    vector<string> lines;
+
+    void write(const char *msg, size_t len) override { lines.push_back(string(msg, len)); }
+};
+
+// GETs share the core; every other method has it to itself.
+static shared_mutex gCoreLock;
+
+static int opStatus(OpResult r)
+{
+    switch (r)
+    {
+    case OP_OK:
+        return 200;
+    case OP_NO_STUDENT:
+    case OP_NO_COURSE:
+    case OP_NOT_FOUND:
+    case OP_WAITLIST_EMPTY:
+        return 404;
+    case OP_PREREQS_MISSING:
+        return 422;
+    default: // duplicates, full courses, limits, cycles
+        return 409;
+    }
+}
+
+static void setResult(ApiReply &reply, OpResult r, int okStatus = 200)
+{
+    reply.status = r == OP_OK ? okStatus : opStatus(r);
+    reply.out.str("result", opResultText(r));
+}
+
+static void setError(ApiReply &reply, int status, const string &error)
+{
+    reply.status = status;
+    reply.out.str("error", error);
+}
+
+static bool segInt(const string &s, int &out)
+{
+    if (s.empty() || s.size() > 11)
+        return false;
+    char *end;
+    long n = strtol(s.c_str(), &end, 10);
+    if (*end || n < INT_MIN || n > INT_MAX)
+        return false;
+    out = (int)n;
+    return true;
+}
+
+static bool requireInt(ApiReply &reply, const JsonBody &in, const char *key, int &out)
+{
+    if (in.getInt(key, out))
+        return true;
+    setError(reply, 400, string("missing or invalid field '") + key + "'");
+    return false;
+}
+
+// GET /health
+// GET /stats
+// GET /students/{id}
+// GET /students/{id}/enrollments
+// GET /courses/{id}
+// GET /courses/{id}/eligibility/{studentID}
+// GET /waitlist/{courseID}
+static bool routeRead(const vector<string> &seg, ApiReply &reply)
+{
+    int id, other;
+    if (seg.size() == 1 && seg[0] == "health")
+    {
+        reply.out.flag("ok", true);
+    }
+    else if (seg.size() == 1 && seg[0] == "stats")
+    {
+        ApiServerStats st = apiServerStats();
+        reply.out.num("students", gStudents.size()).num("courses", courseTable.size());
+        reply.out.num("enrollments", gEnrollments.size()).num("waitlisted", gWaitlists.size());
+        reply.out.num("connections", st.connections).num("requests", st.requests).num("errors", st.errors);
+        reply.out.num("checkpoints", st.checkpoints);
+    }
+    else if (seg.size() >= 2 && seg[0] == "students" && segInt(seg[1], id))
+    {
+        Student *s = searchStudentByID(id);
+        if (!s)
+        {
+            setResult(reply, OP_NO_STUDENT);
+        }
+        else if (seg.size() == 2)
+        {
+            setResult(reply, OP_OK);
+            reply.out.num("id", s->ID).str("name", s->Name).str("email", s->Email);
+            reply.out.str("phone", s->Phone).str("address", s->Address);
+        }
+        else if (seg.size() == 3 && seg[2] == "enrollments")
+        {
+            vector<int> courses;
+            gEnrollments.forEachCourseOf(id, [&](int courseID)
+                                         { courses.push_back(courseID); });
+            setResult(reply, OP_OK);
+            reply.out.num("student", id).raw("courses", jsonIntList(courses));
+        }
+        else
+            return false;
+    }
+    else if (seg.size() >= 2 && seg[0] == "courses" && segInt(seg[1], id))
+    {
+        Course *c = searchCourseByID(id);
+        if (!c)
+        {
+            setResult(reply, OP_NO_COURSE);
+        }
+        else if (seg.size() == 2)
+        {
+            vector<int> prereqs;
+            gPrereqs.forEachPrereq(id, [&](int p)
+                                   { prereqs.push_back(p); });
+            setResult(reply, OP_OK);
+            reply.out.num("id", c->courseID).str("name", c->courseName).num("credits", c->courseCredits);
+            reply.out.str("instructor", c->courseInstructor).num("capacity", c->maxCapacity);
+            reply.out.num("enrolled", c->currentEnrolled).raw("prereqs", jsonIntList(prereqs));
+            reply.out.num("unlocks", gPrereqs.dependantCount(id)).num("waitlisted", gWaitlists.countFor(id));
+        }
+        else if (seg.size() == 4 && seg[2] == "eligibility" && segInt(seg[3], other))
+        {
+            int missing = 0;
+            if (!studentExists(other))
+            {
+                setResult(reply, OP_NO_STUDENT);
+            }
+            else if (gPrereqs.satisfied(other, *c, &missing))
+            {
+                setResult(reply, OP_OK);
+                reply.out.flag("eligible", true);
+            }
+            else
+            {
+                setResult(reply, OP_OK);
+                reply.out.flag("eligible", false).num("missing", missing);
+            }
+        }
+        else
+            return false;
+    }
+    else if (seg.size() == 2 && seg[0] == "waitlist" && segInt(seg[1], id))
+    {
+        if (!courseExists(id))
+        {
+            setResult(reply, OP_NO_COURSE);
+            return true;
+        }
+        string entries = "[";
+        auto add = [&](const WaitlistItem &w)
+        {
+            if (entries.size() > 1)
+                entries += ',';
+            entries += "{\"student\":" + to_string(w.studentID) + ",\"priority\":" + to_string(w.priority) + "}";
+        };
+        gWaitlists.forEachIn(id, add);
+        setResult(reply, OP_OK);
+        reply.out.num("course", id).raw("entries", entries + "]");
+    }
+    else
+        return false;
+    return true;
+}
+
+// POST   /students                      {"id","name","email","phone","address","password"}
+// DELETE /students/{id}
+// POST   /courses                       {"id","name","credits","instructor","capacity","prereqs":[..]}
+// DELETE /courses/{id}
+// PUT    /courses/{id}/capacity         {"capacity"}
+// POST   /courses/{id}/prereqs          {"prereq"}
+// POST   /enrollments                   {"student","course"}
+// DELETE /enrollments/{studentID}/{courseID}
+// POST   /waitlist                      {"student","course","priority"}
+// POST   /waitlist/{courseID}/promote
+static bool routeWrite(const string &method, const vector<string> &seg, const JsonBody &in, ApiReply &reply)
+{
+    int id, other;
+    if (method == "POST" && seg.size() == 1 && seg[0] == "students")
+    {
+        if (requireInt(reply, in, "id", id))
+            setResult(reply, addStudent(id, in.getText("name"), in.getText("email"), in.getText("phone"),
+                                        in.getText("address"), in.getText("password")),
+                      201);
+    }
+    else if (method == "DELETE" && seg.size() == 2 && seg[0] == "students" && segInt(seg[1], id))
+    {
+        setResult(reply, deleteStudent(id));
+    }
+    else if (method == "POST" && seg.size() == 1 && seg[0] == "courses")
+    {
+        Course c;
+        if (!requireInt(reply, in, "id", c.courseID))
+            return true;
+        c.courseName = in.getText("name");
+        c.courseInstructor = in.getText("instructor");
+        c.courseCredits = 0;
+        c.maxCapacity = 0;
+        c.currentEnrolled = 0;
+        in.getInt("credits", c.courseCredits);
+        in.getInt("capacity", c.maxCapacity);
+        c.maxCapacity = max(0, c.maxCapacity);
+        const vector<int> *prereqs = in.getList("prereqs");
+        if (courseExists(c.courseID))
+            setResult(reply, OP_DUPLICATE);
+        else if (!insertCourseBST(c, prereqs ? prereqs->data() : NULL, prereqs ? (int)prereqs->size() : 0))
+            setResult(reply, OP_CYCLE);
+        else
+            setResult(reply, OP_OK, 201);
+    }
+    else if (method == "DELETE" && seg.size() == 2 && seg[0] == "courses" && segInt(seg[1], id))
+    {
+        if (!courseExists(id))
+        {
+            setResult(reply, OP_NO_COURSE);
+        }
+        else
+        {
+            dropCourse(id);
+            setResult(reply, OP_OK);
+        }
+    }
+    else if (method == "PUT" && seg.size() == 3 && seg[0] == "courses" && segInt(seg[1], id) && seg[2] == "capacity")
+    {
+        if (requireInt(reply, in, "capacity", other))
+            setResult(reply, setCourseCapacity(id, other));
+    }
+    else if (method == "POST" && seg.size() == 3 && seg[0] == "courses" && segInt(seg[1], id) && seg[2] == "prereqs")
+    {
+        if (requireInt(reply, in, "prereq", other))
+            setResult(reply, addPrerequisite(id, other));
+    }
+    else if (method == "POST" && seg.size() == 1 && seg[0] == "enrollments")
+    {
+        if (requireInt(reply, in, "student", id) && requireInt(reply, in, "course", other))
+            setResult(reply, addEnrollment(id, other), 201);
+    }
+    else if (method == "DELETE" && seg.size() == 3 && seg[0] == "enrollments" && segInt(seg[1], id) && segInt(seg[2], other))
+    {
+        setResult(reply, removeEnrollment(id, other));
+    }
+    else if (method == "POST" && seg.size() == 1 && seg[0] == "waitlist")
+    {
+        vector<WaitlistRequest> one(1);
+        if (!requireInt(reply, in, "student", one[0].studentID) || !requireInt(reply, in, "course", one[0].courseID))
+            return true;
+        in.getInt("priority", one[0].priority);
+        enqueueWaitlistBatch(one);
+        setResult(reply, one[0].result, 201);
+        if (one[0].result == OP_OK)
+            reply.out.num("position", one[0].position);
+    }
+    else if (method == "POST" && seg.size() == 3 && seg[0] == "waitlist" && segInt(seg[1], id) && seg[2] == "promote")
+    {
+        if (!courseExists(id))
+        {
+            setResult(reply, OP_NO_COURSE);
+        }
+        else
+        {
+            int promoted = promoteWaitlist(id);
+            setResult(reply, OP_OK);
+            reply.out.num("promoted", promoted);
+        }
+    }
+    else
+        return false;
+    return true;
+}
+
+static const char *statusReason(int status)
+{
+    switch (status)
+    {
+    case 200:
+        return "OK";
+    case 201:
+        return "Created";
+    case 400:
+        return "Bad Request";
+    case 404:
+        return "Not Found";
+    case 409:
+        return "Conflict";
+    case 413:
+        return "Payload Too Large";
+    case 422:
+        return "Unprocessable Entity";
+    case 431:
+        return "Request Header Fields Too Large";
+    case 501:
+        return "Not Implemented";
+    default:
+        return "Error";
+    }
+}
+
+static string formatResponse(int status, const string &body, bool keepAlive)
+{
+    char head[192];
+    snprintf(head, sizeof(head),
+             "HTTP/1.1 %d %s\r\nContent-Type: application/json\r\nContent-Length: %zu\r\nConnection: %s\r\n\r\n",
+             status, statusReason(status), body.size(), keepAlive ? "keep-alive" : "close");
+    return head + body;
+}
+
+class ApiJob
+{
+public:
+    long long connID;
+    unsigned long long seq;
+    bool keepAlive = true;
+    bool write = false; // anything but GET changes the core
+    string method;
+    string target;
+    string body;
+    string response; // the full HTTP response, filled in by a worker
+};
+
+static void handleJob(ApiJob &job)
+{
+    vector<string> seg;
+    size_t end = job.target.find('?');
+    string path = job.target.substr(0, end);
+    for (size_t i = 0; i < path.size();)
+    {
+        size_t next = path.find('/', i);
+        if (next == string::npos)
+            next = path.size();
+        if (next > i)
+            seg.push_back(path.substr(i, next - i));
+        i = next + 1;
+    }
+
+    ApiReply reply;
+    JsonBody in;
+    if (!parseJsonBody(job.body, in))
+    {
+        setError(reply, 400, "malformed JSON body");
+    }
+    else
+    {
+        CaptureSink log;
+        ScopedMessageSink capture(&log);
+        bool routed;
+        if (job.method == "GET")
+        {
+            shared_lock<shared_mutex> hold(gCoreLock);
+            routed = routeRead(seg, reply);
+        }
+        else
+        {
+            // Records are appended under the lock but the fsync is awaited
+            // after it is released, so concurrent writes share one group
+            // commit. The response still goes out only once it is durable.
+            JournalBatch durable;
+            unique_lock<shared_mutex> hold(gCoreLock);
+            routed = routeWrite(job.method, seg, in, reply);
+            hold.unlock();
+        }
+        if (!routed)
+            setError(reply, 404, "no endpoint for " + job.method + " " + path);
+        if (!log.lines.empty())
+        {
+            string lines = "[";
+            for (const string &l : log.lines)
+            {
+                if (lines.size() > 1)
+                    lines += ',';
+                appendJsonString(lines, l);
+            }
+            reply.out.raw("messages", lines + "]");
+        }
+    }
+    job.response = formatResponse(reply.status, reply.out.done(), job.keepAlive);
+}
+
+// ---- Event loop (one thread) and worker pool ----
+
+class ApiConnection
+{
+public:
+    int fd;
+    long long id;
+    int listIndex;
+    uint32_t events = 0;
+    string in;          // received, not yet parsed
+    string out;         // ordered responses not yet written
+    size_t outSent = 0;
+    unsigned long long nextSeq = 0;    // given to the next parsed request
+    unsigned long long nextToSend = 0; // responses go out strictly in this order
+    unsigned long long closeAtSeq = ULLONG_MAX;
+    vector<string> ready; // finished responses waiting for earlier ones, by seq
+    vector<char> isReady;
+    deque<ApiJob *> waiting; // parsed, held back behind an earlier write
+    int running = 0;         // handed to the workers, not yet finished
+    bool writeRunning = false;
+    bool paused = false; // on gPaused, not reading
+    bool peerClosed = false;
+};
+
+static const unsigned long long API_LISTEN_ID = 0;
+static const unsigned long long API_WAKE_ID = 1;
+
+static ApiServerConfig gApiConfig;
+static bool gApiRunning = false;
+static atomic<bool> gApiStopping(false);
+static int gListenFd = -1;
+static int gEpollFd = -1;
+static int gWakeFd = -1;
+static thread gLoopThread;
+static vector<thread> gApiWorkers;
+
+static mutex gJobLock;
+static condition_variable gJobReady;
+static deque<ApiJob *> gJobs;
+static mutex gDoneLock;
+static vector<ApiJob *> gDone;
+
+// Owned by the loop thread.
+static FlatIdMap<ApiConnection *> gConns;
+static vector<ApiConnection *> gConnList;
+static vector<long long> gPaused;
+static long long gNextConnID = 2;
+static int gOutstanding = 0; // parsed requests not yet answered
+
+static atomic<long long> gStatConnections(0);
+static atomic<long long> gStatRequests(0);
+static atomic<long long> gStatErrors(0);
+static atomic<long long> gStatCheckpoints(0);
+
+static void apiWorker()
+{
+    while (true)
+    {
+        ApiJob *job;
+        {
+            unique_lock<mutex> lk(gJobLock);
+            gJobReady.wait(lk, []
+                           { return gApiStopping.load() || !gJobs.empty(); });
+            if (gJobs.empty())
+                return;
+            job = gJobs.front();
+            gJobs.pop_front();
+        }
+        handleJob(*job);
+
+        bool wake;
+        {
+            lock_guard<mutex> lk(gDoneLock);
+            wake = gDone.empty(); // otherwise the loop has a wake-up pending already
+            gDone.push_back(job);
+        }
+        if (wake)
+        {
+            uint64_t one = 1;
+            if (write(gWakeFd, &one, sizeof(one)) < 0)
+                gStatErrors++;
+        }
+    }
+}
+
+static void setInterest(ApiConnection *c)
+{
+    uint32_t want = 0;
+    if (!c->paused && !c->peerClosed && c->closeAtSeq == ULLONG_MAX)
+        want |= EPOLLIN;
+    if (c->outSent < c->out.size())
+        want |= EPOLLOUT;
+    if (want == c->events)
+        return;
+    epoll_event ev = {};
+    ev.events = want;
+    ev.data.u64 = (unsigned long long)c->id;
+    epoll_ctl(gEpollFd, EPOLL_CTL_MOD, c->fd, &ev);
+    c->events = want;
+}
+
+static void closeConnection(ApiConnection *c)
+{
+    epoll_ctl(gEpollFd, EPOLL_CTL_DEL, c->fd, NULL);
+    close(c->fd);
+    gConns.erase(c->id);
+    ApiConnection *last = gConnList.back();
+    gConnList[c->listIndex] = last;
+    last->listIndex = c->listIndex;
+    gConnList.pop_back();
+    for (ApiJob *job : c->waiting)
+        delete job;
+    gOutstanding -= (int)c->waiting.size();
+    delete c; // its running jobs are dropped when they come back
+}
+
+static bool connectionBlocked(const ApiConnection *c)
+{
+    return c->nextSeq - c->nextToSend >= (unsigned long long)gApiConfig.maxPipeline ||
+           gOutstanding >= gApiConfig.maxQueued;
+}
+
+// Queues a response the loop produced itself (bad requests) and ends the
+// connection after it.
+static void rejectRequest(ApiConnection *c, int status, const char *error)
+{
+    JsonOut out;
+    out.str("error", error);
+    unsigned long long seq = c->nextSeq++;
+    size_t slot = seq % c->ready.size();
+    c->ready[slot] = formatResponse(status, out.done(), false);
+    c->isReady[slot] = 1;
+    c->closeAtSeq = seq;
+    gStatErrors++;
+}
+
+static string lowerCase(string s)
+{
+    for (char &ch : s)
+        ch = (char)tolower((unsigned char)ch);
+    return s;
+}
+
+// Parses the head of one request ([0, headLen) of text); 0 or an error status.
+static int parseRequestHead(const char *text, size_t headLen, ApiJob &job, long &contentLength)
+{
+    string head(text, headLen);
+    size_t lineEnd = head.find("\r\n");
+    string requestLine = head.substr(0, lineEnd);
+    size_t sp1 = requestLine.find(' ');
+    size_t sp2 = sp1 == string::npos ? string::npos : requestLine.find(' ', sp1 + 1);
+    if (sp2 == string::npos)
+        return 400;
+    job.method = requestLine.substr(0, sp1);
+    job.target = requestLine.substr(sp1 + 1, sp2 - sp1 - 1);
+    string version = requestLine.substr(sp2 + 1);
+    if (version.compare(0, 7, "HTTP/1.") != 0 || job.target.empty() || job.target[0] != '/')
+        return 400;
+    job.keepAlive = version != "HTTP/1.0";
+
+    contentLength = 0;
+    size_t pos = lineEnd == string::npos ? head.size() : lineEnd + 2;
+    while (pos < head.size())
+    {
+        size_t end = head.find("\r\n", pos);
+        if (end == string::npos)
+            end = head.size();
+        size_t colon = head.find(':', pos);
+        if (colon == string::npos || colon > end)
+            return 400;
+        string name = lowerCase(head.substr(pos, colon - pos));
+        size_t v = colon + 1;
+        while (v < end && (head[v] == ' ' || head[v] == '\t'))
+            v++;
+        string value = head.substr(v, end - v);
+        while (!value.empty() && (value.back() == ' ' || value.back() == '\t'))
+            value.pop_back();
+
+        if (name == "content-length")
+        {
+            if (value.empty() || value.size() > 9 || value.find_first_not_of("0123456789") != string::npos)
+                return 400;
+            contentLength = atol(value.c_str());
+            if (contentLength > API_MAX_BODY)
+                return 413;
+        }
+        else if (name == "transfer-encoding")
+        {
+            return 501; // clients send Content-Length; chunked bodies are not supported
+        }
+        else if (name == "connection")
+        {
+            string token = lowerCase(value);
+            if (token.find("close") != string::npos)
+                job.keepAlive = false;
+            else if (token.find("keep-alive") != string::npos)
+                job.keepAlive = true;
+        }
+        pos = end + 2;
+    }
+    return 0;
+}
+
+// Hands a connection's parsed requests to the workers. Reads run side by
+// side, but a write waits for everything sent before it and holds back
+// everything sent after it, so each client's changes apply in its order.
+static void dispatchJobs(ApiConnection *c)
+{
+    vector<ApiJob *> jobs;
+    while (!c->waiting.empty() && !c->writeRunning)
+    {
+        ApiJob *job = c->waiting.front();
+        if (job->write && c->running > 0)
+            break;
+        c->waiting.pop_front();
+        c->running++;
+        c->writeRunning = job->write;
+        jobs.push_back(job);
+    }
+    if (jobs.empty())
+        return;
+    {
+        lock_guard<mutex> lk(gJobLock);
+        gJobs.insert(gJobs.end(), jobs.begin(), jobs.end());
+    }
+    if (jobs.size() == 1)
+        gJobReady.notify_one();
+    else
+        gJobReady.notify_all();
+}
+
+// Hands every complete request in the buffer to the workers, in order, until
+// the connection's pipeline or the global queue is full.
+static void parseRequests(ApiConnection *c)
+{
+    size_t pos = 0;
+    while (c->closeAtSeq == ULLONG_MAX && !connectionBlocked(c))
+    {
+        size_t headEnd = c->in.find("\r\n\r\n", pos);
+        if (headEnd == string::npos)
+        {
+            if (c->in.size() - pos > API_MAX_HEAD)
+                rejectRequest(c, 431, "request head too large");
+            break;
+        }
+        if (headEnd - pos > API_MAX_HEAD)
+        {
+            rejectRequest(c, 431, "request head too large");
+            break;
+        }
+
+        ApiJob *job = new ApiJob;
+        long contentLength;
+        int status = parseRequestHead(c->in.data() + pos, headEnd - pos, *job, contentLength);
+        if (status != 0)
+        {
+            delete job;
+            rejectRequest(c, status, status == 413 ? "body too large" : status == 501 ? "chunked bodies are not supported" : "malformed request");
+            break;
+        }
+        size_t bodyStart = headEnd + 4;
+        if (c->in.size() - bodyStart < (size_t)contentLength)
+        {
+            delete job;
+            break; // wait for the rest of the body
+        }
+
+        job->body.assign(c->in, bodyStart, contentLength);
+        job->connID = c->id;
+        job->seq = c->nextSeq++;
+        job->write = job->method != "GET";
+        if (!job->keepAlive)
+            c->closeAtSeq = job->seq;
+        pos = bodyStart + contentLength;
+        gOutstanding++;
+        gStatRequests++;
+        c->waiting.push_back(job);
+    }
+    c->in.erase(0, pos);
+    dispatchJobs(c);
+
+    bool blocked = c->closeAtSeq == ULLONG_MAX && connectionBlocked(c);
+    if (blocked && !c->paused)
+        gPaused.push_back(c->id);
+    c->paused = blocked;
+}
+
+// Writes whatever responses are due; false if the connection was closed.
+static bool flushConnection(ApiConnection *c)
+{
+    while (c->nextToSend < c->nextSeq)
+    {
+        size_t slot = c->nextToSend % c->ready.size();
+        if (!c->isReady[slot])
+            break;
+        c->out += c->ready[slot];
+        c->ready[slot].clear();
+        c->isReady[slot] = 0;
+        c->nextToSend++;
+    }
+
+    while (c->outSent < c->out.size())
+    {
+        ssize_t n = send(c->fd, c->out.data() + c->outSent, c->out.size() - c->outSent, MSG_NOSIGNAL);
+        if (n > 0)
+            c->outSent += n;
+        else if (n < 0 && errno == EINTR)
+            continue;
+        else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        else
+        {
+            closeConnection(c);
+            return false;
+        }
+    }
+    if (c->outSent == c->out.size())
+    {
+        c->out.clear();
+        c->outSent = 0;
+    }
+
+    bool drained = c->out.empty() && c->nextToSend == c->nextSeq;
+    if (drained && (c->nextToSend > c->closeAtSeq || c->peerClosed))
+    {
+        closeConnection(c);
+        return false;
+    }
+    setInterest(c);
+    return true;
+}
+
+static void readConnection(ApiConnection *c)
+{
+    char buf[16384];
+    size_t got = 0;
+    while (got < API_READ_CHUNK)
+    {
+        ssize_t n = recv(c->fd, buf, sizeof(buf), 0);
+        if (n > 0)
+        {
+            c->in.append(buf, n);
+            got += n;
+        }
+        else if (n == 0)
+        {
+            c->peerClosed = true;
+            break;
+        }
+        else if (errno == EINTR)
+            continue;
+        else if (errno == EAGAIN || errno == EWOULDBLOCK)
+            break;
+        else
+        {
+            closeConnection(c);
+            return;
+        }
+    }
+    parseRequests(c);
+    flushConnection(c);
+}
+
+static void acceptClients()
+{
+    while (true)
+    {
+        int fd = accept4(gListenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        if ((int)gConnList.size() >= gApiConfig.maxConnections)
+        {
+            close(fd);
+            gStatErrors++;
+            continue;
+        }
+        int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+        ApiConnection *c = new ApiConnection;
+        c->fd = fd;
+        c->id = gNextConnID++;
+        c->listIndex = (int)gConnList.size();
+        c->ready.resize(gApiConfig.maxPipeline + 1);
+        c->isReady.assign(gApiConfig.maxPipeline + 1, 0);
+        c->events = EPOLLIN;
+        gConns.insert(c->id, c);
+        gConnList.push_back(c);
+
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.u64 = (unsigned long long)c->id;
+        epoll_ctl(gEpollFd, EPOLL_CTL_ADD, fd, &ev);
+        gStatConnections++;
+    }
+}
+
+static void drainCompletions()
+{
+    uint64_t count;
+    if (read(gWakeFd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+        gStatErrors++;
+
+    vector<ApiJob *> done;
+    {
+        lock_guard<mutex> lk(gDoneLock);
+        done.swap(gDone);
+    }
+    vector<long long> touched;
+    for (ApiJob *job : done)
+    {
+        gOutstanding--;
+        ApiConnection **found = gConns.find(job->connID);
+        if (found)
+        {
+            ApiConnection *c = *found;
+            c->running--;
+            if (job->write)
+                c->writeRunning = false;
+            size_t slot = job->seq % c->ready.size();
+            c->ready[slot].swap(job->response);
+            c->isReady[slot] = 1;
+            if (touched.empty() || touched.back() != c->id)
+                touched.push_back(c->id);
+        }
+        delete job;
+    }
+    for (long long id : touched)
+    {
+        ApiConnection **found = gConns.find(id);
+        if (!found)
+            continue;
+        dispatchJobs(*found);
+        flushConnection(*found);
+    }
+}
+
+// Lets paused connections parse again once the queue or their pipeline has room.
+static void resumePaused()
+{
+    if (gPaused.empty() || gOutstanding >= gApiConfig.maxQueued)
+        return;
+    vector<long long> waiting;
+    waiting.swap(gPaused);
+    for (size_t i = 0; i < waiting.size(); i++)
+    {
+        ApiConnection **found = gConns.find(waiting[i]);
+        if (!found)
+            continue;
+        ApiConnection *c = *found;
+        if (connectionBlocked(c))
+        {
+            gPaused.push_back(c->id);
+            continue;
+        }
+        c->paused = false;
+        parseRequests(c);
+        flushConnection(c);
+    }
+}
+
+// The console calls journalMaintenance() between menu actions. While serving,
+// the loop calls it instead, every API_MAINTENANCE_MS, so the journal is
+// checkpointed rather than growing without bound. The exclusive lock keeps
+// writers out while the checkpoint switches generations.
+static void maintainJournal(chrono::steady_clock::time_point &last)
+{
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    if (!journalEnabled() || now - last < chrono::milliseconds(API_MAINTENANCE_MS))
+        return;
+    last = now;
+    unique_lock<shared_mutex> hold(gCoreLock);
+    if (journalMaintenance())
+        gStatCheckpoints++;
+}
+
+static void apiLoop()
+{
+    ScopedMessageSink quiet(NULL);
+    chrono::steady_clock::time_point lastMaintenance = chrono::steady_clock::now();
+    epoll_event events[256];
+    while (!gApiStopping.load())
+    {
+        int n = epoll_wait(gEpollFd, events, 256, 200);
+        if (n < 0 && errno != EINTR)
+            break;
+        for (int i = 0; i < n; i++)
+        {
+            unsigned long long id = events[i].data.u64;
+            if (id == API_LISTEN_ID)
+            {
+                acceptClients();
+                continue;
+            }
+            if (id == API_WAKE_ID)
+            {
+                drainCompletions();
+                continue;
+            }
+            ApiConnection **found = gConns.find((long long)id);
+            if (!found)
+                continue;
+            ApiConnection *c = *found;
+            if (events[i].events & (EPOLLERR | EPOLLHUP))
+                closeConnection(c);
+            else if (events[i].events & EPOLLIN)
+                readConnection(c);
+            else if (events[i].events & EPOLLOUT)
+                flushConnection(c);
+        }
+        resumePaused();
+        maintainJournal(lastMaintenance);
+    }
+}
+
+static void closeApiSockets()
+{
+    if (gListenFd >= 0)
+        close(gListenFd);
+    if (gEpollFd >= 0)
+        close(gEpollFd);
+    if (gWakeFd >= 0)
+        close(gWakeFd);
+    gListenFd = gEpollFd = gWakeFd = -1;
+}
+
+bool startApiServer(const ApiServerConfig &config)
+{
+    if (gApiRunning)
+        return false;
+    gApiConfig = config;
+    gApiConfig.maxQueued = max(1, gApiConfig.maxQueued);
+    gApiConfig.maxPipeline = max(1, gApiConfig.maxPipeline);
+    gApiConfig.maxConnections = max(1, gApiConfig.maxConnections);
+    int cores = max(1, (int)thread::hardware_concurrency());
+    int workers = gApiConfig.workers > 0 ? gApiConfig.workers : journalEnabled() ? max(16, 4 * cores) : cores;
+
+    gListenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)gApiConfig.port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int on = 1;
+    if (gListenFd < 0 || setsockopt(gListenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) < 0 ||
+        ::bind(gListenFd, (sockaddr *)&addr, sizeof(addr)) < 0 || listen(gListenFd, SOMAXCONN) < 0)
+    {
+        coreMessage("API server: cannot listen on 127.0.0.1:%d (%s).", gApiConfig.port, strerror(errno));
+        closeApiSockets();
+        return false;
+    }
+
+    gEpollFd = epoll_create1(EPOLL_CLOEXEC);
+    gWakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_event ev = {};
+    ev.events = EPOLLIN;
+    ev.data.u64 = API_LISTEN_ID;
+    bool ok = gEpollFd >= 0 && gWakeFd >= 0 && epoll_ctl(gEpollFd, EPOLL_CTL_ADD, gListenFd, &ev) == 0;
+    ev.data.u64 = API_WAKE_ID;
+    if (!ok || epoll_ctl(gEpollFd, EPOLL_CTL_ADD, gWakeFd, &ev) < 0)
+    {
+        coreMessage("API server: cannot set up the event loop (%s).", strerror(errno));
+        closeApiSockets();
+        return false;
+    }
+
+    gApiStopping = false;
+    gStatConnections = 0;
+    gStatRequests = 0;
+    gStatErrors = 0;
+    gStatCheckpoints = 0;
+    for (int i = 0; i < workers; i++)
+        gApiWorkers.push_back(thread(apiWorker));
+    gLoopThread = thread(apiLoop);
+    gApiRunning = true;
+    coreMessage("API server listening on http://127.0.0.1:%d with %d worker(s).", gApiConfig.port, workers);
+    return true;
+}
+
+void stopApiServer()
+{
+    if (!gApiRunning)
+        return;
+    gApiStopping = true;
+    uint64_t one = 1;
+    if (write(gWakeFd, &one, sizeof(one)) < 0)
+        gStatErrors++;
+    gLoopThread.join();
+    {
+        lock_guard<mutex> lk(gJobLock); // no worker may miss the stop between its check and its wait
+    }
+    gJobReady.notify_all();
+    for (thread &t : gApiWorkers)
+        t.join();
+    gApiWorkers.clear();
+
+    for (ApiJob *job : gDone)
+        delete job;
+    gDone.clear();
+    while (!gConnList.empty())
+        closeConnection(gConnList.back());
+    gConns.clear();
+    gPaused.clear();
+    gOutstanding = 0;
+    closeApiSockets();
+    gApiRunning = false;
+    coreMessage("API server stopped after %lld request(s) on %lld connection(s).",
+                gStatRequests.load(), gStatConnections.load());
+}
+
+ApiServerStats apiServerStats()
+{
+    ApiServerStats st;
+    st.connections = gStatConnections.load();
+    st.requests = gStatRequests.load();
+    st.errors = gStatErrors.load();
+    st.checkpoints = gStatCheckpoints.load();
+    return st;
+}
+
+#else
+
+bool startApiServer(const ApiServerConfig &)
+{
+    coreMessage("The API server needs Linux (epoll) and is not available in this build.");
+    return false;
+}
+
+void stopApiServer()
+{
+}
+
+ApiServerStats apiServerStats()
+{
+    return ApiServerStats();
+}
+
+#endif
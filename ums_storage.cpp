@@ -0,0 +1,1401 @@
+#include "ums_core.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <charconv>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ---- Binary snapshot -------------------------------------------------------
+// Layout: SnapshotHeader, then 8-byte aligned sections at the offsets it lists:
+// string table (raw bytes), students, courses, prerequisite IDs, enrollments
+// (insertion order) and waitlist items (arrival order). Strings are StrRefs into
+// the string table, so every record has a fixed width and loading is a bounds
+// check plus a pointer cast over the mapped file.
+static const char SNAPSHOT_MAGIC[8] = {'U', 'M', 'S', 'S', 'N', 'A', 'P', 0};
+static const uint32_t SNAPSHOT_VERSION = 3; // v2 added journalGen, v3 waitlist priorities
+static const uint32_t SNAPSHOT_V1_HEADER_SIZE = 112;
+
+class StrRef
+{
+public:
+    uint32_t offset;
+    uint32_t length;
+};
+
+class SnapshotHeader
+{
+public:
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t stringBytes, stringOffset;
+    uint64_t studentCount, studentOffset;
+    uint64_t courseCount, courseOffset;
+    uint64_t prereqCount, prereqOffset;
+    uint64_t enrollmentCount, enrollmentOffset;
+    uint64_t waitlistCount, waitlistOffset;
+    uint64_t journalGen; // journal generation that continues from this snapshot
+};
+
+class SnapStudent
+{
+public:
+    int32_t id;
+    uint32_t pad;
+    StrRef name, email, phone, address, password;
+};
+
+class SnapCourse
+{
+public:
+    int32_t id;
+    int32_t credits;
+    int32_t maxCapacity;
+    int32_t currentEnrolled;
+    StrRef name, instructor;
+    uint32_t prereqStart;
+    uint32_t prereqCount;
+};
+
+class SnapPair // enrollments, and waitlist items before v3
+{
+public:
+    int32_t studentID;
+    int32_t courseID;
+};
+
+class SnapWaitlist
+{
+public:
+    int32_t studentID;
+    int32_t courseID;
+    int32_t priority;
+    uint32_t pad;
+};
+
+static StrRef addSnapString(string &table, const string &str)
+{
+    StrRef r;
+    r.offset = (uint32_t)table.size();
+    r.length = (uint32_t)str.size();
+    table += str;
+    return r;
+}
+
+static void padTo8(string &out)
+{
+    while (out.size() % 8 != 0)
+        out.push_back('\0');
+}
+
+template <typename T>
+static uint64_t appendSection(string &out, const vector<T> &items)
+{
+    padTo8(out);
+    uint64_t offset = out.size();
+    if (!items.empty())
+        out.append(reinterpret_cast<const char *>(items.data()), items.size() * sizeof(T));
+    return offset;
+}
+
+// Serializes the whole database into `out`; the caller decides where it goes.
+void buildSnapshot(string &out, uint64_t journalGen)
+{
+    string strings;
+    vector<SnapStudent> students;
+    vector<SnapCourse> courses;
+    vector<int32_t> prereqs;
+    vector<SnapPair> enrollments;
+    vector<SnapWaitlist> waitlist;
+
+    students.reserve(gStudents.size());
+    for (const Student &st : gStudents.records)
+    {
+        SnapStudent r;
+        r.id = st.ID;
+        r.pad = 0;
+        r.name = addSnapString(strings, st.Name);
+        r.email = addSnapString(strings, st.Email);
+        r.phone = addSnapString(strings, st.Phone);
+        r.address = addSnapString(strings, st.Address);
+        r.password = addSnapString(strings, st.Password);
+        students.push_back(r);
+    }
+
+    vector<CourseNode *> stack;
+    CourseNode *node = gCourseRoot;
+    while (node || !stack.empty())
+    {
+        while (node)
+        {
+            stack.push_back(node);
+            node = node->left;
+        }
+        node = stack.back();
+        stack.pop_back();
+
+        const Course &c = node->data;
+        SnapCourse r;
+        r.id = c.courseID;
+        r.credits = c.courseCredits;
+        r.maxCapacity = c.maxCapacity;
+        r.currentEnrolled = c.currentEnrolled;
+        r.name = addSnapString(strings, c.courseName);
+        r.instructor = addSnapString(strings, c.courseInstructor);
+        r.prereqStart = (uint32_t)prereqs.size();
+        gPrereqs.forEachPrereq(c.courseID, [&](int p)
+                               { prereqs.push_back(p); });
+        r.prereqCount = (uint32_t)prereqs.size() - r.prereqStart;
+        courses.push_back(r);
+
+        node = node->right;
+    }
+
+    enrollments.reserve(gEnrollments.size());
+    gEnrollments.forEach([&](const Enrollment &e)
+                         { enrollments.push_back({e.studentID, e.courseID}); });
+
+    waitlist.reserve(gWaitlists.size());
+    gWaitlists.forEach([&](const WaitlistItem &w)
+                       { waitlist.push_back({w.studentID, w.courseID, w.priority, 0}); });
+
+    SnapshotHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic));
+    h.version = SNAPSHOT_VERSION;
+    h.headerSize = sizeof(SnapshotHeader);
+    h.journalGen = journalGen;
+
+    out.assign(sizeof(SnapshotHeader), '\0');
+    padTo8(out);
+    h.stringOffset = out.size();
+    h.stringBytes = strings.size();
+    out += strings;
+    h.studentCount = students.size();
+    h.studentOffset = appendSection(out, students);
+    h.courseCount = courses.size();
+    h.courseOffset = appendSection(out, courses);
+    h.prereqCount = prereqs.size();
+    h.prereqOffset = appendSection(out, prereqs);
+    h.enrollmentCount = enrollments.size();
+    h.enrollmentOffset = appendSection(out, enrollments);
+    h.waitlistCount = waitlist.size();
+    h.waitlistOffset = appendSection(out, waitlist);
+    memcpy(&out[0], &h, sizeof(h));
+}
+
+// Writes to a temporary file first and renames it over `path`, so a crash
+// mid-save leaves the previous snapshot intact.
+bool writeFileAtomically(const char *path, const string &bytes)
+{
+    string tmp = string(path) + ".tmp";
+    FILE *f = fopen(tmp.c_str(), "wb");
+    if (!f)
+        return false;
+    bool ok = fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+    ok = (fflush(f) == 0) && ok;
+#ifdef _WIN32
+    ok = (_commit(_fileno(f)) == 0) && ok;
+#else
+    ok = (fsync(fileno(f)) == 0) && ok;
+#endif
+    ok = (fclose(f) == 0) && ok;
+    if (!ok)
+    {
+        remove(tmp.c_str());
+        return false;
+    }
+#ifdef _WIN32
+    remove(path); // rename() does not replace an existing file on Windows
+#endif
+    return rename(tmp.c_str(), path) == 0;
+}
+
+// Read-only view of a whole file: mmap where available, a heap copy otherwise.
+class MappedFile
+{
+public:
+    const char *data = NULL;
+    size_t size = 0;
+
+    bool open(const char *path)
+    {
+        close();
+#ifdef _WIN32
+        FILE *f = fopen(path, "rb");
+        if (!f)
+            return false;
+        fseek(f, 0, SEEK_END);
+        long len = ftell(f);
+        fseek(f, 0, SEEK_SET);
+        if (len < 0)
+        {
+            fclose(f);
+            return false;
+        }
+        copy.resize((size_t)len);
+        bool ok = len == 0 || fread(&copy[0], 1, (size_t)len, f) == (size_t)len;
+        fclose(f);
+        if (!ok)
+            return false;
+        data = copy.data();
+        size = copy.size();
+        return true;
+#else
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED)
+            return false;
+        data = static_cast<const char *>(p);
+        size = (size_t)st.st_size;
+        mapped = true;
+        return true;
+#endif
+    }
+
+    void close()
+    {
+#ifndef _WIN32
+        if (mapped)
+            munmap(const_cast<char *>(data), size);
+        mapped = false;
+#endif
+        copy.clear();
+        data = NULL;
+        size = 0;
+    }
+
+    ~MappedFile() { close(); }
+
+private:
+    string copy;
+    bool mapped = false;
+};
+
+static bool snapSectionFits(const MappedFile &file, uint64_t offset, uint64_t count, size_t width)
+{
+    return offset % 8 == 0 && offset <= file.size &&
+           count <= (file.size - offset) / width;
+}
+
+static string snapString(const char *table, const StrRef &r)
+{
+    return string(table + r.offset, r.length);
+}
+
+bool loadSnapshot(const char *path, uint64_t *journalGen)
+{
+    MappedFile file;
+    if (!file.open(path))
+    {
+        coreMessage("Error: could not open snapshot %s.", path);
+        return false;
+    }
+
+    SnapshotHeader h;
+    memset(&h, 0, sizeof(h));
+    if (file.size < SNAPSHOT_V1_HEADER_SIZE)
+    {
+        coreMessage("Error: %s is not a snapshot.", path);
+        return false;
+    }
+    memcpy(&h, file.data, SNAPSHOT_V1_HEADER_SIZE);
+    if (memcmp(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic)) != 0)
+    {
+        coreMessage("Error: %s is not a snapshot.", path);
+        return false;
+    }
+    if (h.version < 1 || h.version > SNAPSHOT_VERSION)
+    {
+        coreMessage("Error: snapshot version %u is not supported.", (unsigned)h.version);
+        return false;
+    }
+    uint32_t expectedHeader = h.version == 1 ? SNAPSHOT_V1_HEADER_SIZE : (uint32_t)sizeof(h);
+    if (h.headerSize != expectedHeader || file.size < expectedHeader)
+    {
+        coreMessage("Error: %s is not a snapshot.", path);
+        return false;
+    }
+    memcpy(&h, file.data, expectedHeader);
+    if (h.stringOffset > file.size || h.stringBytes > file.size - h.stringOffset ||
+        !snapSectionFits(file, h.studentOffset, h.studentCount, sizeof(SnapStudent)) ||
+        !snapSectionFits(file, h.courseOffset, h.courseCount, sizeof(SnapCourse)) ||
+        !snapSectionFits(file, h.prereqOffset, h.prereqCount, sizeof(int32_t)) ||
+        !snapSectionFits(file, h.enrollmentOffset, h.enrollmentCount, sizeof(SnapPair)) ||
+        !snapSectionFits(file, h.waitlistOffset, h.waitlistCount,
+                         h.version < 3 ? sizeof(SnapPair) : sizeof(SnapWaitlist)))
+    {
+        coreMessage("Error: snapshot %s is truncated or corrupt.", path);
+        return false;
+    }
+
+    const char *strings = file.data + h.stringOffset;
+    const SnapStudent *students = reinterpret_cast<const SnapStudent *>(file.data + h.studentOffset);
+    const SnapCourse *courses = reinterpret_cast<const SnapCourse *>(file.data + h.courseOffset);
+    const int32_t *prereqs = reinterpret_cast<const int32_t *>(file.data + h.prereqOffset);
+    const SnapPair *enrollments = reinterpret_cast<const SnapPair *>(file.data + h.enrollmentOffset);
+    const char *waitlist = file.data + h.waitlistOffset;
+
+    for (uint64_t i = 0; i < h.studentCount; i++)
+    {
+        const StrRef *refs[] = {&students[i].name, &students[i].email, &students[i].phone,
+                                &students[i].address, &students[i].password};
+        for (const StrRef *r : refs)
+        {
+            if ((uint64_t)r->offset + r->length > h.stringBytes)
+            {
+                coreMessage("Error: snapshot %s is truncated or corrupt.", path);
+                return false;
+            }
+        }
+    }
+    for (uint64_t i = 0; i < h.courseCount; i++)
+    {
+        const SnapCourse &c = courses[i];
+        if ((uint64_t)c.name.offset + c.name.length > h.stringBytes ||
+            (uint64_t)c.instructor.offset + c.instructor.length > h.stringBytes ||
+            (uint64_t)c.prereqStart + c.prereqCount > h.prereqCount)
+        {
+            coreMessage("Error: snapshot %s is truncated or corrupt.", path);
+            return false;
+        }
+    }
+
+    JournalPause pause; // the journal continues from this state, it does not record it
+    PrereqBatch closures;
+    resetAllData();
+
+    gStudents.reserve((int)h.studentCount);
+    for (uint64_t i = 0; i < h.studentCount; i++)
+    {
+        const SnapStudent &r = students[i];
+        Student st;
+        st.ID = r.id;
+        st.Name = snapString(strings, r.name);
+        st.Email = snapString(strings, r.email);
+        st.Phone = snapString(strings, r.phone);
+        st.Address = snapString(strings, r.address);
+        st.Password = snapString(strings, r.password);
+        gStudents.insert(st);
+    }
+
+    gCourseNodes.reserve((int)h.courseCount);
+    courseTable.reserve((int)h.courseCount);
+    for (uint64_t i = 0; i < h.courseCount; i++)
+    {
+        const SnapCourse &r = courses[i];
+        Course c;
+        c.courseID = r.id;
+        c.courseName = snapString(strings, r.name);
+        c.courseCredits = r.credits;
+        c.courseInstructor = snapString(strings, r.instructor);
+        c.maxCapacity = r.maxCapacity;
+        c.currentEnrolled = r.currentEnrolled;
+        insertCourseBST(c, prereqs + r.prereqStart, (int)r.prereqCount);
+    }
+
+    gEnrollments.reserve((int)h.enrollmentCount, (int)h.studentCount, (int)h.courseCount);
+    for (uint64_t i = 0; i < h.enrollmentCount; i++)
+    {
+        gEnrollments.insert(enrollments[i].studentID, enrollments[i].courseID);
+    }
+
+    for (uint64_t i = 0; i < h.waitlistCount; i++)
+    {
+        if (h.version < 3)
+        {
+            const SnapPair &w = reinterpret_cast<const SnapPair *>(waitlist)[i];
+            gWaitlists.insert(w.studentID, w.courseID, 0);
+        }
+        else
+        {
+            const SnapWaitlist &w = reinterpret_cast<const SnapWaitlist *>(waitlist)[i];
+            gWaitlists.insert(w.studentID, w.courseID, w.priority);
+        }
+    }
+
+    if (journalGen)
+        *journalGen = h.journalGen;
+    coreMessage("Snapshot loaded from %s (%d students, %d courses, %d enrollments).", path,
+                gStudents.size(), courseTable.size(), gEnrollments.size());
+    return true;
+}
+
+// ---- Write-ahead journal ----------------------------------------------------
+// Every successful mutation appends a JournalRecord to ums_data.wal.<gen>.
+// A flusher thread writes everything that accumulated while its previous fsync
+// was running, fsyncs once and wakes every writer in that batch (group commit).
+// journalWrite() returns only once its record is durable, unless a JournalBatch
+// defers that wait.
+//
+// The snapshot header names the generation that continues from it. A checkpoint
+// serializes the state, switches appends to the next generation, then writes the
+// snapshot and deletes older journals on a background thread. Recovery loads the
+// snapshot and replays its generation and any later ones, stopping at a torn tail.
+static const char JOURNAL_MAGIC[8] = {'U', 'M', 'S', 'W', 'A', 'L', 0, 0};
+static const size_t CHECKPOINT_JOURNAL_BYTES = 32 * 1024 * 1024;
+
+class Crc32Table
+{
+public:
+    uint32_t entry[256];
+
+    Crc32Table()
+    {
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            entry[i] = c;
+        }
+    }
+};
+
+static uint32_t crc32Of(const char *data, size_t len)
+{
+    static const Crc32Table crcTable; // magic static: built once, safe from any thread
+    const uint32_t *table = crcTable.entry;
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < len; i++)
+        crc = table[(crc ^ (unsigned char)data[i]) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+
+static string journalPath(uint64_t gen)
+{
+    return string(SNAPSHOT_PATH).substr(0, strlen(SNAPSHOT_PATH) - 5) + ".wal." + to_string(gen);
+}
+
+static bool syncFile(FILE *f)
+{
+    if (fflush(f) != 0)
+        return false;
+#ifdef _WIN32
+    return _commit(_fileno(f)) == 0;
+#else
+    return fsync(fileno(f)) == 0;
+#endif
+}
+
+class Journal
+{
+public:
+    uint64_t gen = 0;
+    size_t bytesSinceCheckpoint = 0;
+
+    bool open(uint64_t newGen)
+    {
+        FILE *f = fopen(journalPath(newGen).c_str(), "wb");
+        if (!f)
+            return false;
+        fwrite(JOURNAL_MAGIC, 1, sizeof(JOURNAL_MAGIC), f);
+        fwrite(&newGen, sizeof(newGen), 1, f);
+        if (!syncFile(f))
+        {
+            fclose(f);
+            return false;
+        }
+
+        unique_lock<mutex> lk(m);
+        FILE *old = file;
+        file = f;
+        gen = newGen;
+        bytesSinceCheckpoint = 0;
+        gJournalEnabled = true;
+        if (!flusher.joinable())
+        {
+            stopping = false;
+            flusher = thread(&Journal::flushLoop, this);
+        }
+        lk.unlock();
+        if (old)
+            fclose(old);
+        return true;
+    }
+
+    void close()
+    {
+        {
+            lock_guard<mutex> lk(m);
+            stopping = true;
+        }
+        wake.notify_all();
+        if (flusher.joinable())
+            flusher.join();
+        if (file)
+            fclose(file);
+        file = NULL;
+        gJournalEnabled = false;
+    }
+
+    uint64_t append(const string &rec)
+    {
+        lock_guard<mutex> lk(m);
+        if (pending.empty())
+            wake.notify_one();
+        pending += rec;
+        bytesSinceCheckpoint += rec.size();
+        return ++appendedLsn;
+    }
+
+    bool waitDurable(uint64_t lsn)
+    {
+        unique_lock<mutex> lk(m);
+        durable.wait(lk, [&]
+                     { return durableLsn >= lsn || stopping; });
+        return !failed && durableLsn >= lsn;
+    }
+
+    uint64_t lastLsn()
+    {
+        lock_guard<mutex> lk(m);
+        return appendedLsn;
+    }
+
+    ~Journal() { close(); }
+
+private:
+    FILE *file = NULL;
+    string pending;
+    uint64_t appendedLsn = 0;
+    uint64_t durableLsn = 0;
+    bool stopping = false;
+    bool failed = false;
+    mutex m;
+    condition_variable wake;
+    condition_variable durable;
+    thread flusher;
+
+    void flushLoop()
+    {
+        unique_lock<mutex> lk(m);
+        while (true)
+        {
+            wake.wait(lk, [&]
+                      { return stopping || !pending.empty(); });
+            if (pending.empty())
+                break; // stopping, nothing left to write
+
+            string batch;
+            batch.swap(pending);
+            uint64_t upto = appendedLsn;
+            FILE *f = file;
+            lk.unlock();
+            bool ok = f && fwrite(batch.data(), 1, batch.size(), f) == batch.size() && syncFile(f);
+            lk.lock();
+            if (!ok)
+                failed = true;
+            durableLsn = upto;
+            durable.notify_all();
+        }
+        durable.notify_all();
+    }
+};
+
+atomic<bool> gJournalEnabled(false);
+atomic<int> gJournalPauseDepth(0);
+Journal gJournal;
+static thread_local int tJournalBatchDepth = 0;
+static thread_local uint64_t tJournalBatchLsn = 0;
+
+JournalPause::JournalPause() { gJournalPauseDepth++; }
+JournalPause::~JournalPause() { gJournalPauseDepth--; }
+
+JournalBatch::JournalBatch() { tJournalBatchDepth++; }
+JournalBatch::~JournalBatch()
+{
+    if (--tJournalBatchDepth == 0 && tJournalBatchLsn)
+    {
+        if (!gJournal.waitDurable(tJournalBatchLsn))
+            coreMessage("Warning: journal write failed; recent changes are not durable.");
+        tJournalBatchLsn = 0;
+    }
+}
+
+void journalWrite(JournalRecord &rec)
+{
+    if (!journalActive())
+        return;
+    uint32_t len = (uint32_t)(rec.bytes.size() - 9);
+    uint32_t crc = crc32Of(rec.bytes.data() + 8, rec.bytes.size() - 8);
+    memcpy(&rec.bytes[0], &len, sizeof(len));
+    memcpy(&rec.bytes[4], &crc, sizeof(crc));
+
+    uint64_t lsn = gJournal.append(rec.bytes);
+    if (tJournalBatchDepth > 0)
+        tJournalBatchLsn = lsn;
+    else if (!gJournal.waitDurable(lsn))
+        coreMessage("Warning: journal write failed; recent changes are not durable.");
+}
+
+class JournalReader
+{
+public:
+    const char *p;
+    const char *end;
+    bool ok = true;
+
+    int32_t i32()
+    {
+        int32_t v = 0;
+        if (end - p < (ptrdiff_t)sizeof(v))
+        {
+            ok = false;
+            return 0;
+        }
+        memcpy(&v, p, sizeof(v));
+        p += sizeof(v);
+        return v;
+    }
+
+    string str()
+    {
+        int32_t len = i32();
+        if (!ok || len < 0 || end - p < len)
+        {
+            ok = false;
+            return string();
+        }
+        string v(p, (size_t)len);
+        p += len;
+        return v;
+    }
+};
+
+// Re-applies one record's effect directly to the stores; validation already
+// happened when the record was written.
+static bool applyJournalRecord(int op, JournalReader &r)
+{
+    if (op == JOP_ADD_STUDENT)
+    {
+        Student st;
+        st.ID = r.i32();
+        st.Name = r.str();
+        st.Email = r.str();
+        st.Phone = r.str();
+        st.Address = r.str();
+        st.Password = r.str();
+        if (r.ok)
+            gStudents.insert(st);
+    }
+    else if (op == JOP_DELETE_STUDENT)
+    {
+        int id = r.i32();
+        if (r.ok)
+            gStudents.erase(id);
+    }
+    else if (op == JOP_INSERT_COURSE)
+    {
+        Course c;
+        c.courseID = r.i32();
+        c.courseName = r.str();
+        c.courseCredits = r.i32();
+        c.courseInstructor = r.str();
+        c.maxCapacity = r.i32();
+        c.currentEnrolled = r.i32();
+        int n = r.i32();
+        if (n < 0 || n > (r.end - r.p) / (int)sizeof(int32_t))
+            return false;
+        vector<int> prereqIDs(n);
+        for (int i = 0; i < n; i++)
+            prereqIDs[i] = r.i32();
+        if (r.ok)
+            insertCourseBST(c, prereqIDs.data(), n);
+    }
+    else if (op == JOP_DROP_COURSE)
+    {
+        int id = r.i32();
+        if (r.ok)
+            dropCourse(id);
+    }
+    else if (op == JOP_ADD_PREREQ)
+    {
+        int courseID = r.i32();
+        int prereqID = r.i32();
+        if (r.ok)
+            addPrerequisite(courseID, prereqID);
+    }
+    else if (op == JOP_ADD_ENROLLMENT)
+    {
+        int studentID = r.i32();
+        int courseID = r.i32();
+        Course *c = searchCourseByID(courseID);
+        if (r.ok && gEnrollments.insert(studentID, courseID) && c)
+            c->currentEnrolled++;
+    }
+    else if (op == JOP_REMOVE_ENROLLMENT)
+    {
+        int studentID = r.i32();
+        int courseID = r.i32();
+        Course *c = searchCourseByID(courseID);
+        if (r.ok && gEnrollments.erase(studentID, courseID) && c && c->currentEnrolled > 0)
+            c->currentEnrolled--;
+    }
+    else if (op == JOP_ENQUEUE_WAITLIST)
+    {
+        int studentID = r.i32();
+        int courseID = r.i32();
+        int priority = r.p < r.end ? r.i32() : 0; // older records have no priority
+        if (r.ok)
+            gWaitlists.insert(studentID, courseID, priority);
+    }
+    else if (op == JOP_DEQUEUE_WAITLIST)
+    {
+        if (r.p < r.end)
+        {
+            int studentID = r.i32();
+            int courseID = r.i32();
+            if (r.ok)
+                gWaitlists.erase(studentID, courseID);
+        }
+        else if (const WaitlistItem *w = gWaitlists.oldest())
+        {
+            gWaitlists.erase(w->studentID, w->courseID); // older records: the one global queue's front
+        }
+    }
+    else if (op == JOP_RESET_ALL)
+    {
+        resetAllData();
+    }
+    else if (op == JOP_SET_CAPACITY)
+    {
+        int courseID = r.i32();
+        int maxCapacity = r.i32();
+        Course *c = searchCourseByID(courseID);
+        if (r.ok && c)
+            c->maxCapacity = maxCapacity;
+    }
+    else
+    {
+        return false;
+    }
+    return r.ok;
+}
+
+// Replays one journal generation; returns the number of records applied or -1 if the file is missing.
+static long replayJournal(uint64_t gen)
+{
+    MappedFile file;
+    if (!file.open(journalPath(gen).c_str()))
+        return -1;
+    if (file.size < 16 || memcmp(file.data, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) != 0)
+        return 0;
+
+    JournalPause pause;
+    PrereqBatch closures;
+    long applied = 0;
+    const char *p = file.data + 16;
+    const char *end = file.data + file.size;
+    while (end - p >= 9)
+    {
+        uint32_t len, crc;
+        memcpy(&len, p, sizeof(len));
+        memcpy(&crc, p + 4, sizeof(crc));
+        if ((size_t)(end - p - 9) < len || crc32Of(p + 8, len + 1) != crc)
+            break; // torn tail from a crash mid-write
+        JournalReader r;
+        r.p = p + 9;
+        r.end = p + 9 + len;
+        if (!applyJournalRecord((unsigned char)p[8], r))
+            break;
+        applied++;
+        p += 9 + len;
+    }
+    return applied;
+}
+
+static thread gCheckpointThread;
+static atomic<bool> gCheckpointRunning(false);
+static uint64_t gOldestJournalGen = 0;
+// Set when startup found a snapshot it could not read. The generation numbers
+// are unknown then, so any checkpoint would overwrite that snapshot and leave
+// later journals to be replayed over the new one.
+static bool gRecoveryFailed = false;
+
+static bool refuseIfRecoveryFailed()
+{
+    if (!gRecoveryFailed)
+        return false;
+    coreMessage("Error: %s could not be read at startup, so saving is disabled to keep it intact. "
+                "Move it and its journals aside, then restart.",
+                SNAPSHOT_PATH);
+    return true;
+}
+
+// Starts a new journal generation and writes the matching snapshot, either
+// inline or on a background thread. Journals older than the new generation are
+// deleted only after the snapshot is safely renamed into place.
+bool checkpointDatabase(bool background)
+{
+    if (refuseIfRecoveryFailed())
+        return false;
+    if (gCheckpointThread.joinable())
+        gCheckpointThread.join();
+
+    uint64_t newGen = gJournal.gen + 1;
+    if (gJournalEnabled)
+        gJournal.waitDurable(gJournal.lastLsn());
+
+    string *bytes = new string();
+    buildSnapshot(*bytes, newGen);
+    if (!gJournal.open(newGen))
+    {
+        delete bytes;
+        coreMessage("Error: could not start journal %s.", journalPath(newGen).c_str());
+        return false;
+    }
+
+    uint64_t oldest = gOldestJournalGen;
+    auto finish = [bytes, newGen, oldest]()
+    {
+        bool ok = writeFileAtomically(SNAPSHOT_PATH, *bytes);
+        if (ok)
+        {
+            for (uint64_t g = oldest; g < newGen; g++)
+                remove(journalPath(g).c_str());
+        }
+        delete bytes;
+        gCheckpointRunning = false;
+        return ok;
+    };
+
+    gCheckpointRunning = true;
+    if (background)
+    {
+        gCheckpointThread = thread(finish);
+        gOldestJournalGen = newGen; // older files are the background thread's to delete
+        return true;
+    }
+    if (!finish())
+    {
+        coreMessage("Error: could not write snapshot %s.", SNAPSHOT_PATH);
+        return false;
+    }
+    gOldestJournalGen = newGen;
+    return true;
+}
+
+bool journalEnabled()
+{
+    return gJournalEnabled;
+}
+
+// Called between user actions: starts a background checkpoint once the
+// journal has grown past CHECKPOINT_JOURNAL_BYTES. True if one was started.
+bool journalMaintenance()
+{
+    if (gJournalEnabled && !gCheckpointRunning &&
+        gJournal.bytesSinceCheckpoint >= CHECKPOINT_JOURNAL_BYTES)
+    {
+        return checkpointDatabase(true);
+    }
+    return false;
+}
+
+// Startup: snapshot + journal replay, then a fresh generation. Returns false if
+// an existing snapshot could not be read; journaling then stays off and every
+// checkpoint and import is refused, so nothing overwrites it.
+bool recoverDatabase()
+{
+    uint64_t gen = 0;
+    FILE *existing = fopen(SNAPSHOT_PATH, "rb");
+    if (existing)
+    {
+        fclose(existing);
+        if (!loadSnapshot(SNAPSHOT_PATH, &gen))
+        {
+            gRecoveryFailed = true;
+            return false;
+        }
+    }
+
+    long replayed = 0;
+    uint64_t g = gen;
+    while (true)
+    {
+        long n = replayJournal(g);
+        if (n < 0)
+            break;
+        replayed += n;
+        g++;
+    }
+    if (replayed > 0)
+        coreMessage("Replayed %ld journal records.", replayed);
+
+    gOldestJournalGen = gen;
+    gJournal.gen = g > gen ? g - 1 : gen;
+    return checkpointDatabase(false);
+}
+
+// Reloads the last snapshot and starts a new generation, discarding the journal written since.
+bool revertToSnapshot()
+{
+    if (gCheckpointThread.joinable())
+        gCheckpointThread.join();
+    if (!loadSnapshot(SNAPSHOT_PATH))
+        return false;
+    return checkpointDatabase(false);
+}
+
+void shutdownDatabase()
+{
+    if (gJournalEnabled)
+        checkpointDatabase(false);
+    if (gCheckpointThread.joinable())
+        gCheckpointThread.join();
+    gJournal.close();
+}
+
+// ---- Bulk CSV/TSV import -----------------------------------------------------
+// Files are mapped, cut into newline-aligned chunks and parsed on one thread per
+// chunk. Rows are then applied to the stores in one single-threaded pass with
+// every index pre-sized. The delimiter (tab or comma) is taken from the first
+// line, a header row is skipped if its first field is not a number, and
+// "quoted, fields" are supported (but not newlines inside quotes).
+//   students:    id,name,email,phone,address,password
+//   courses:     id,name,credits,instructor,capacity,prereqs (IDs separated by ';')
+//   enrollments: studentID,courseID
+// Import bypasses the journal and finishes with a checkpoint instead.
+static const size_t IMPORT_MIN_CHUNK = 1 << 20;
+static const int IMPORT_MAX_ERRORS = 10;
+
+class ImportReport
+{
+public:
+    string what;
+    long rows = 0;
+    long accepted = 0;
+    long rejected = 0;
+    double parseSeconds = 0;
+    double buildSeconds = 0;
+    vector<string> errors; // first IMPORT_MAX_ERRORS problems
+
+    void reject(const string &why)
+    {
+        rejected++;
+        if ((int)errors.size() < IMPORT_MAX_ERRORS)
+            errors.push_back(why);
+    }
+
+    void print() const
+    {
+        double total = parseSeconds + buildSeconds;
+        coreMessage("  %-12s rows: %-8ld accepted: %-8ld rejected: %-6ld parse: %.3fs build: %.3fs (%.0f rows/s)",
+                    what.c_str(), rows, accepted, rejected, parseSeconds, buildSeconds,
+                    total > 0 ? rows / total : 0.0);
+        for (const string &e : errors)
+            coreMessage("      %s", e.c_str());
+        if (rejected > (long)errors.size())
+            coreMessage("      ... %ld more", rejected - (long)errors.size());
+    }
+};
+
+class ImportStudentRow
+{
+public:
+    long line;
+    Student data;
+};
+
+class ImportCourseRow
+{
+public:
+    long line;
+    Course data;
+    vector<int> prereqs;
+};
+
+class ImportEnrollmentRow
+{
+public:
+    long line;
+    int studentID;
+    int courseID;
+};
+
+// Splits one line into fields; handles "quoted" fields with "" escapes.
+class FieldScanner
+{
+public:
+    const char *p;
+    const char *end;
+    char delim;
+    string scratch;
+
+    bool next(string &out)
+    {
+        if (p > end)
+            return false;
+        if (p < end && *p == '"')
+        {
+            scratch.clear();
+            p++;
+            while (p < end)
+            {
+                if (*p == '"')
+                {
+                    if (p + 1 < end && p[1] == '"')
+                    {
+                        scratch.push_back('"');
+                        p += 2;
+                        continue;
+                    }
+                    p++;
+                    break;
+                }
+                scratch.push_back(*p++);
+            }
+            const char *d = static_cast<const char *>(memchr(p, delim, end - p));
+            p = d ? d + 1 : end + 1;
+            out.swap(scratch);
+            return true;
+        }
+        const char *d = static_cast<const char *>(memchr(p, delim, end - p));
+        const char *fieldEnd = d ? d : end;
+        out.assign(p, fieldEnd);
+        p = fieldEnd + 1;
+        return true;
+    }
+
+    bool nextInt(int &out)
+    {
+        if (p > end)
+            return false;
+        const char *d = static_cast<const char *>(memchr(p, delim, end - p));
+        const char *fieldEnd = d ? d : end;
+        const char *b = p;
+        while (b < fieldEnd && (*b == ' ' || *b == '"'))
+            b++;
+        from_chars_result r = from_chars(b, fieldEnd, out);
+        p = fieldEnd + 1;
+        if (r.ec != errc())
+            return false;
+        for (const char *q = r.ptr; q < fieldEnd; q++)
+        {
+            if (*q != ' ' && *q != '"')
+                return false;
+        }
+        return true;
+    }
+};
+
+static bool parseStudentLine(FieldScanner &f, long line, ImportStudentRow &row)
+{
+    row.line = line;
+    return f.nextInt(row.data.ID) && f.next(row.data.Name) && f.next(row.data.Email) &&
+           f.next(row.data.Phone) && f.next(row.data.Address) && f.next(row.data.Password);
+}
+
+static bool parseCourseLine(FieldScanner &f, long line, ImportCourseRow &row)
+{
+    row.line = line;
+    string prereqs;
+    if (!(f.nextInt(row.data.courseID) && f.next(row.data.courseName) && f.nextInt(row.data.courseCredits) &&
+          f.next(row.data.courseInstructor) && f.nextInt(row.data.maxCapacity)))
+        return false;
+    row.data.currentEnrolled = 0;
+    if (!f.next(prereqs))
+        return true; // prerequisite column is optional
+    const char *p = prereqs.data();
+    const char *end = p + prereqs.size();
+    while (p < end)
+    {
+        while (p < end && (*p == ';' || *p == ' ' || *p == '|'))
+            p++;
+        if (p == end)
+            break;
+        int id;
+        from_chars_result r = from_chars(p, end, id);
+        if (r.ec != errc())
+            return false;
+        row.prereqs.push_back(id);
+        p = r.ptr;
+    }
+    return true;
+}
+
+static bool parseEnrollmentLine(FieldScanner &f, long line, ImportEnrollmentRow &row)
+{
+    row.line = line;
+    return f.nextInt(row.studentID) && f.nextInt(row.courseID);
+}
+
+// Parses `file` on all cores. Each chunk yields its rows plus the lines it could
+// not parse; `rows` comes back in file order.
+template <typename Row, typename ParseFn>
+static bool parseDelimitedFile(const char *path, vector<Row> &rows, ImportReport &report, ParseFn parse)
+{
+    auto t0 = chrono::steady_clock::now();
+    MappedFile file;
+    if (!file.open(path))
+    {
+        coreMessage("Error: could not open %s.", path);
+        return false;
+    }
+
+    const char *begin = file.data;
+    const char *end = file.data + file.size;
+    const char *firstEol = static_cast<const char *>(memchr(begin, '\n', end - begin));
+    const char *firstLineEnd = firstEol ? firstEol : end;
+    char delim = memchr(begin, '\t', firstLineEnd - begin) ? '\t' : ',';
+    const char *b = begin;
+    while (b < firstLineEnd && (*b == ' ' || *b == '"'))
+        b++;
+    if (b < firstLineEnd && !isdigit((unsigned char)*b) && *b != '-')
+        begin = firstEol ? firstEol + 1 : end; // header row
+
+    int threads = (int)thread::hardware_concurrency();
+    if (threads < 1)
+        threads = 1;
+    size_t bytes = end - begin;
+    int chunks = (int)min<size_t>(threads, bytes / IMPORT_MIN_CHUNK + 1);
+
+    vector<const char *> cuts(chunks + 1);
+    cuts[0] = begin;
+    cuts[chunks] = end;
+    for (int i = 1; i < chunks; i++)
+    {
+        const char *c = begin + bytes * i / chunks;
+        if (c < cuts[i - 1])
+            c = cuts[i - 1];
+        const char *eol = static_cast<const char *>(memchr(c, '\n', end - c));
+        cuts[i] = eol ? eol + 1 : end;
+    }
+
+    vector<vector<Row>> parts(chunks);
+    vector<vector<long>> badLines(chunks);
+    vector<long> lineCounts(chunks, 0);
+    auto work = [&](int ci)
+    {
+        FieldScanner f;
+        const char *p = cuts[ci];
+        const char *stop = cuts[ci + 1];
+        long line = 0;
+        while (p < stop)
+        {
+            const char *eol = static_cast<const char *>(memchr(p, '\n', stop - p));
+            const char *lineEnd = eol ? eol : stop;
+            const char *contentEnd = lineEnd;
+            if (contentEnd > p && contentEnd[-1] == '\r')
+                contentEnd--;
+            if (contentEnd > p)
+            {
+                f.p = p;
+                f.end = contentEnd;
+                f.delim = delim;
+                Row row;
+                if (parse(f, line, row))
+                    parts[ci].push_back(std::move(row));
+                else
+                    badLines[ci].push_back(line);
+            }
+            line++;
+            p = lineEnd + 1;
+        }
+        lineCounts[ci] = line;
+    };
+
+    vector<thread> pool;
+    for (int i = 1; i < chunks; i++)
+        pool.push_back(thread(work, i));
+    work(0);
+    for (thread &t : pool)
+        t.join();
+
+    long firstLine = (begin == file.data) ? 1 : 2; // 1-based, after any header
+    size_t total = 0;
+    for (int i = 0; i < chunks; i++)
+        total += parts[i].size();
+    rows.reserve(rows.size() + total);
+    long offset = firstLine;
+    for (int i = 0; i < chunks; i++)
+    {
+        for (Row &r : parts[i])
+        {
+            r.line += offset;
+            rows.push_back(std::move(r));
+        }
+        for (long bad : badLines[i])
+            report.reject("line " + to_string(bad + offset) + ": malformed row");
+        report.rows += (long)parts[i].size() + (long)badLines[i].size();
+        offset += lineCounts[i];
+    }
+    report.parseSeconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    return true;
+}
+
+static void importStudentRows(vector<ImportStudentRow> &rows, ImportReport &report)
+{
+    auto t0 = chrono::steady_clock::now();
+    gStudents.reserve(gStudents.size() + (int)rows.size());
+    for (ImportStudentRow &r : rows)
+    {
+        int id = r.data.ID;
+        if (gStudents.insert(r.data))
+            report.accepted++;
+        else
+            report.reject("line " + to_string(r.line) + ": student " + to_string(id) + " already exists");
+    }
+    report.buildSeconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+}
+
+// A course is accepted only if every prerequisite exists in the catalog or is
+// itself an accepted row of this import; rejections cascade to dependants.
+static void importCourseRows(vector<ImportCourseRow> &rows, ImportReport &report)
+{
+    auto t0 = chrono::steady_clock::now();
+    sort(rows.begin(), rows.end(), [](const ImportCourseRow &a, const ImportCourseRow &b)
+         { return a.data.courseID < b.data.courseID; });
+
+    vector<char> ok(rows.size(), 1);
+    FlatIdMap<int> incoming;
+    incoming.reserve((int)rows.size());
+    for (size_t i = 0; i < rows.size(); i++)
+    {
+        const ImportCourseRow &r = rows[i];
+        if (courseExists(r.data.courseID) || !incoming.insert(r.data.courseID, (int)i))
+        {
+            ok[i] = 0;
+            report.reject("line " + to_string(r.line) + ": course " + to_string(r.data.courseID) + " already exists");
+        }
+    }
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (size_t i = 0; i < rows.size(); i++)
+        {
+            if (!ok[i])
+                continue;
+            for (int pre : rows[i].prereqs)
+            {
+                int *j = incoming.find(pre);
+                if (courseExists(pre) || (j && ok[*j] && *j != (int)i))
+                    continue;
+                ok[i] = 0;
+                changed = true;
+                report.reject("line " + to_string(rows[i].line) + ": prerequisite " + to_string(pre) +
+                              " of course " + to_string(rows[i].data.courseID) + " does not exist");
+                break;
+            }
+        }
+    }
+
+    gCourseNodes.reserve((int)rows.size());
+    courseTable.reserve(courseTable.size() + (int)rows.size());
+    for (size_t i = 0; i < rows.size(); i++)
+    {
+        if (!ok[i])
+            continue;
+        const Course &c = rows[i].data;
+        if (insertCourseBST(c, rows[i].prereqs.data(), (int)rows[i].prereqs.size()))
+            report.accepted++;
+        else
+            report.reject("line " + to_string(rows[i].line) + ": course " + to_string(c.courseID) +
+                          " would create a prerequisite cycle");
+    }
+    report.buildSeconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+}
+
+static void importEnrollmentRows(vector<ImportEnrollmentRow> &rows, ImportReport &report)
+{
+    auto t0 = chrono::steady_clock::now();
+    gEnrollments.reserve(gEnrollments.size() + (int)rows.size(), gStudents.size(), courseTable.size());
+    for (const ImportEnrollmentRow &r : rows)
+    {
+        Course *c = searchCourseByID(r.courseID);
+        if (!studentExists(r.studentID))
+            report.reject("line " + to_string(r.line) + ": student " + to_string(r.studentID) + " does not exist");
+        else if (!c)
+            report.reject("line " + to_string(r.line) + ": course " + to_string(r.courseID) + " does not exist");
+        else if (!gEnrollments.insert(r.studentID, r.courseID))
+            report.reject("line " + to_string(r.line) + ": duplicate enrollment");
+        else
+        {
+            c->currentEnrolled++;
+            report.accepted++;
+        }
+    }
+    report.buildSeconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+}
+
+// Imports whichever of the three files are given (NULL or "" to skip), in
+// dependency order, then checkpoints so the result is durable without
+// journaling every row.
+bool bulkImport(const char *studentsPath, const char *coursesPath, const char *enrollmentsPath)
+{
+    if (refuseIfRecoveryFailed())
+        return false;
+    bool ok = true;
+    vector<ImportReport> reports;
+    {
+        JournalPause pause;
+        PrereqBatch closures;
+        if (studentsPath && *studentsPath)
+        {
+            ImportReport rep;
+            rep.what = "Students";
+            vector<ImportStudentRow> rows;
+            if (parseDelimitedFile(studentsPath, rows, rep, parseStudentLine))
+            {
+                importStudentRows(rows, rep);
+                reports.push_back(rep);
+            }
+            else
+                ok = false;
+        }
+        if (coursesPath && *coursesPath)
+        {
+            ImportReport rep;
+            rep.what = "Courses";
+            vector<ImportCourseRow> rows;
+            if (parseDelimitedFile(coursesPath, rows, rep, parseCourseLine))
+            {
+                importCourseRows(rows, rep);
+                reports.push_back(rep);
+            }
+            else
+                ok = false;
+        }
+        if (enrollmentsPath && *enrollmentsPath)
+        {
+            ImportReport rep;
+            rep.what = "Enrollments";
+            vector<ImportEnrollmentRow> rows;
+            if (parseDelimitedFile(enrollmentsPath, rows, rep, parseEnrollmentLine))
+            {
+                importEnrollmentRows(rows, rep);
+                reports.push_back(rep);
+            }
+            else
+                ok = false;
+        }
+    }
+
+    coreMessage("-- Import Summary --");
+    for (const ImportReport &rep : reports)
+        rep.print();
+    if (gJournalEnabled && !reports.empty())
+        checkpointDatabase(false);
+    return ok;
+}